@@ -1,11 +1,7 @@
 // TODO:
 // 2. Add camera controller (mouse panning and rotation)
 // 4. UI solution via ImGUI
-// 5. Can I move the mesh vertices dynamically?
-// 6. Add a renderer that encapsulates shit
 // 8. Add resource manager (for mesh, texture, shader, etc)
-// 9. add MeshAsset and MeshInstance?
-// 10. Add Scene
 // 11. Make Texture editable (you can draw on it)
 
 
@@ -21,48 +17,51 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_opengl.h>
 
+#include "camel/GeometryArena.h"
 #include "camel/Mesh.h"
 #include "camel/Shader.h"
+#include "camel/ProgramCache.h"
 #include "camel/Texture.h"
-#include "camel/Light.h"
 #include "camel/Camera.h"
+#include "camel/Renderer.h"
+#include "camel/Scene.h"
 #include "camel/Input.h"
 #include "camel/Application.h"
 
 using namespace Camel;
 
+// Used both when cooking and loading, so the cooked files match what the app asks for
+static const MeshImportSettings s_MeshImportSettings = { .vertexFormat = VertexFormat::COMPACT, .buildClusters = true };
+
 class SimpleApp : public Application
 {
 public:
 	SimpleApp(const int width, const int height, const std::string& title)
-		: Application(width, height, title)
-	{}
+		: Application(width, height, title), m_Arena(VertexLayout::Get(s_MeshImportSettings.vertexFormat), 1 << 18, 1 << 20)
+	{
+		ProgramCache::SetDirectory("cache/shaders");
+	}
 
 	~SimpleApp() override
 	{
-		delete m_Shader;
-		delete m_Mesh;
-		delete m_MeshTransform;
-		delete m_Texture;
 		delete m_Camera;
-		delete m_Light;
 	}
 
 	virtual void OnStart() override
 	{
-		m_Shader = new Shader(Shader::Load("res/shaders/Diffuse_vert.shader", "res/shaders/Diffuse_frag.shader"));
-		m_Shader->Bind();
+		// Loaded in the background, OnUpdate only renders once everything is ready
+		m_Texture = GetAssetLoader().LoadTexture("res/textures/palette.png", Camel::Texture::FilterMode::NEAREST);
 
-		m_Mesh = new Mesh(Mesh::Load("res/models/sword.obj"));
-		m_MeshTransform = new Transform(glm::vec3(0, 0, 5));
-
-		m_Texture = new Texture(Texture::Load("res/textures/palette.png", Camel::Texture::FilterMode::NEAREST));
-		m_Texture->Bind();
+		m_MeshEntity = m_Scene.CreateEntity(glm::vec3(0, 0, 5));
+		// Meshes in the arena drawn with a shader reading InstanceData are batched into one multi-draw by the renderer
+		m_Scene.AddComponent<MeshInstance>(m_MeshEntity, GetAssetLoader().LoadMesh("res/models/sword.obj", s_MeshImportSettings, &m_Arena));
+		m_Scene.AddComponent<Material>(m_MeshEntity, GetAssetLoader().LoadShader("res/shaders/DiffuseInstanced_vert.shader", "res/shaders/DiffuseInstanced_frag.shader"), m_Texture);
 
 		m_Camera = new Camera(glm::vec3(0.0f, 0.0f, 0.0f), glm::quat(glm::vec3(0.0f, 0, 0.0f)), 90.0f, GetAspectRatio());
-		m_Camera->GetTransform().LookAt(m_MeshTransform->GetPosition());
+		m_Camera->GetTransform().LookAt(m_Scene.GetComponent<Transform>(m_MeshEntity).GetPosition());
 
-		m_Light = new Light(glm::vec3(5.0f, 10.0f, -5.0f), glm::vec3(1.0f, 0.95f, 0.9f));
+		m_LightEntity = m_Scene.CreateEntity(glm::vec3(5.0f, 10.0f, -5.0f));
+		m_Scene.AddComponent<Light>(m_LightEntity, glm::vec3(1.0f, 0.95f, 0.9f));
 	}
 
 	virtual void OnUpdate(float deltaTime) override
@@ -115,26 +114,30 @@ public:
 		}
 
 		// TEMP
+		Transform& lightTransform = m_Scene.GetComponent<Transform>(m_LightEntity);
 
 		if (Input::GetKey(SDL_SCANCODE_LEFT))
-			m_Light->GetTransform().Translate(m_Light->GetTransform().GetLeft() * 0.1f);
+			lightTransform.Translate(lightTransform.GetLeft() * 0.1f);
 
 		if (Input::GetKey(SDL_SCANCODE_RIGHT))
-			m_Light->GetTransform().Translate(m_Light->GetTransform().GetRight() * 0.1f);
+			lightTransform.Translate(lightTransform.GetRight() * 0.1f);
 
 		if (Input::GetKey(SDL_SCANCODE_UP))
-			m_Light->GetTransform().Translate(m_Light->GetTransform().GetUp() * 0.1f);
+			lightTransform.Translate(lightTransform.GetUp() * 0.1f);
 
 		if (Input::GetKey(SDL_SCANCODE_DOWN))
-			m_Light->GetTransform().Translate(m_Light->GetTransform().GetDown() * 0.1f);
+			lightTransform.Translate(lightTransform.GetDown() * 0.1f);
 
 		if (Input::GetKey(SDL_SCANCODE_Z))
-			m_Light->GetTransform().Translate(m_Light->GetTransform().GetUp() * 0.1f);
+			lightTransform.Translate(lightTransform.GetUp() * 0.1f);
 
 		if (Input::GetKey(SDL_SCANCODE_X))
-			m_Light->GetTransform().Translate(m_Light->GetTransform().GetDown() * 0.1f);
+			lightTransform.Translate(lightTransform.GetDown() * 0.1f);
+
+		glm::vec3 rotation = glm::vec3(0.3f, 0.5f, -0.7f);
+		m_Scene.GetComponent<Transform>(m_MeshEntity).Rotate(rotation * deltaTime);
 
-		if (Input::GetKeyDown(SDL_SCANCODE_1))
+		if (m_Texture.IsReady() && Input::GetKeyDown(SDL_SCANCODE_1))
 		{
 			for (int y = 0; y < m_Texture->GetHeight(); y++)
 				for (int x = 0; x < m_Texture->GetWidth(); x++)
@@ -142,7 +145,7 @@ public:
 			m_Texture->UpdateTexture();
 		}
 
-		if (Input::GetKeyDown(SDL_SCANCODE_2))
+		if (m_Texture.IsReady() && Input::GetKeyDown(SDL_SCANCODE_2))
 		{
 			for (int x = 0; x < m_Texture->GetWidth(); x++)
 				for (int y = 0; y < m_Texture->GetHeight(); y++)
@@ -150,42 +153,45 @@ public:
 			m_Texture->UpdateTexture();
 		}
 
-		glm::vec3 rotation = glm::vec3(0.3f, 0.5f, -0.7f);
-		m_MeshTransform->Rotate(rotation * deltaTime);
-
-		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		m_Shader->SetUniform1i("u_DiffuseImage", 0);
-
-		m_Shader->SetUniformMatrix4f("u_Model", m_MeshTransform->GetMatrix());
-		m_Shader->SetUniformMatrix4f("u_View", m_Camera->GetViewMatrix());
-		m_Shader->SetUniformMatrix4f("u_Projection", m_Camera->GetProjectionMatrix());
-
-		m_Shader->SetUniform3f("u_LightPos", m_Light->GetTransform().GetPosition());
-		m_Shader->SetUniform3f("u_LightColor", m_Light->GetColor());
-
-		m_Shader->SetUniform3f("u_ViewPos", m_Camera->GetTransform().GetPosition());
-
-		m_Shader->SetUniform3f("u_SkyColor", 0.3f, 0.7f, 1.0f);
-		m_Shader->SetUniform3f("u_GroundColor", 0.5f, 0.4f, 0.3f);
-		m_Shader->SetUniform3f("u_BaseColor", 1.0f, 1.0f, 1.0f);
-
-		m_Mesh->Draw();
+		// Entities whose assets are still loading are skipped
+		m_Scene.Update(&GetJobSystem());
+		m_Scene.Render(m_Renderer, *m_Camera, (float)GetHeight());
 	}
 
 private:
 	// TODO: Temporary ghetto raw pointers
-	Shader* m_Shader = nullptr;
 	Camera* m_Camera = nullptr;
-	Mesh* m_Mesh = nullptr;
-	Transform* m_MeshTransform = nullptr;
-	Texture* m_Texture = nullptr;
-	Light* m_Light = nullptr;
+	GeometryArena m_Arena; // Outlives the meshes of the scene
+	Scene m_Scene;
+	Renderer m_Renderer;
+	entt::entity m_MeshEntity = entt::null;
+	entt::entity m_LightEntity = entt::null;
+	AssetHandle<Texture> m_Texture;
 };
 
 int main(int argc, char* argv[])
 {
+	// Offline cook step, e.g. Camel --cook res/models/sword.obj
+	if (argc > 1 && std::string(argv[1]) == "--cook")
+	{
+		// Keep going past failures so one run reports every broken file, std::cerr since release builds compile logging out
+		int result = 0;
+		for (int i = 2; i < argc; i++)
+		{
+			try
+			{
+				Mesh::Cook(argv[i], s_MeshImportSettings);
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << "Failed to cook " << argv[i] << ": " << e.what() << std::endl;
+				result = 1;
+			}
+		}
+
+		return result;
+	}
+
 	SimpleApp app(1280, 720, "Camel");
 	app.Run();
 
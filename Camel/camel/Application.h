@@ -1,6 +1,14 @@
 #pragma once
 
 #include "Core.h"
+#include "AssetLoader.h"
+#include "GLState.h"
+#include "JobSystem.h"
+#include "TransformHierarchy.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
 
 namespace Camel
 {
@@ -8,7 +16,8 @@ namespace Camel
 	{
 	public:
 		Application(const int width, const int height, const std::string& title)
-			: m_IsRunning(false), m_Window(nullptr), m_Context(nullptr)
+			: m_IsRunning(false), m_Window(nullptr), m_Context(nullptr), m_JobSystem(std::make_unique<JobSystem>()), m_AssetLoader(std::make_unique<AssetLoader>(*m_JobSystem)), m_AssetUploadBudget(0.002),
+			m_FixedTimeStep(0.0), m_TargetFrameTime(0.0), m_InterpolationAlpha(0.0f)
 		{
 			if (SDL_Init(SDL_INIT_VIDEO) != 0)
 			{
@@ -48,12 +57,12 @@ namespace Camel
 				return;
 			}
 
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			GLState::SetEnabled(GL_BLEND, true);
+			GLState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-			glEnable(GL_DEPTH_TEST);
+			GLState::SetEnabled(GL_DEPTH_TEST, true);
 
-			glEnable(GL_CULL_FACE);
+			GLState::SetEnabled(GL_CULL_FACE, true);
 			glFrontFace(GL_CW); // Left Handedness
 
 			CAMEL_LOG_INFO("GL Version: {}", std::string(reinterpret_cast<const char*>(glGetString(GL_VERSION))));
@@ -65,7 +74,13 @@ namespace Camel
 		Application(Application&& other) noexcept
 			: m_Window(other.m_Window),
 			m_Context(other.m_Context),
-			m_IsRunning(other.m_IsRunning)
+			m_IsRunning(other.m_IsRunning),
+			m_JobSystem(std::move(other.m_JobSystem)),
+			m_AssetLoader(std::move(other.m_AssetLoader)),
+			m_AssetUploadBudget(other.m_AssetUploadBudget),
+			m_FixedTimeStep(other.m_FixedTimeStep),
+			m_TargetFrameTime(other.m_TargetFrameTime),
+			m_InterpolationAlpha(other.m_InterpolationAlpha)
 		{
 			other.m_Window = nullptr;
 			other.m_Context = nullptr;
@@ -82,6 +97,12 @@ namespace Camel
 				m_Window = other.m_Window;
 				m_Context = other.m_Context;
 				m_IsRunning = other.m_IsRunning;
+				m_AssetLoader = std::move(other.m_AssetLoader);
+				m_JobSystem = std::move(other.m_JobSystem);
+				m_AssetUploadBudget = other.m_AssetUploadBudget;
+				m_FixedTimeStep = other.m_FixedTimeStep;
+				m_TargetFrameTime = other.m_TargetFrameTime;
+				m_InterpolationAlpha = other.m_InterpolationAlpha;
 
 				other.m_Window = nullptr;
 				other.m_Context = nullptr;
@@ -92,6 +113,10 @@ namespace Camel
 
 		virtual ~Application()
 		{
+			// Pending uploads own GL objects' data, release them while the context is alive
+			if (m_AssetLoader)
+				m_AssetLoader->Shutdown();
+
 			SDL_GL_DeleteContext(m_Context);
 			SDL_DestroyWindow(m_Window);
 			SDL_Quit();
@@ -120,6 +145,27 @@ namespace Camel
 
 		inline void Quit() noexcept { m_IsRunning = false; }
 
+		inline AssetLoader& GetAssetLoader() noexcept { return *m_AssetLoader; }
+
+		// Shared with the engine stages, OnUpdate can submit jobs and wait on them within the frame
+		inline JobSystem& GetJobSystem() noexcept { return *m_JobSystem; }
+
+		// Time per frame spent creating GL objects for assets loaded in the background
+		inline double GetAssetUploadBudget() const noexcept { return m_AssetUploadBudget; }
+		inline void SetAssetUploadBudget(const double seconds) noexcept { m_AssetUploadBudget = seconds; }
+
+		// Seconds between OnFixedUpdate calls, 0 disables the fixed step
+		inline double GetFixedTimeStep() const noexcept { return m_FixedTimeStep; }
+		inline void SetFixedTimeStep(const double seconds) noexcept { m_FixedTimeStep = seconds; }
+
+		// Minimum seconds per frame, 0 leaves the frame rate unlimited
+		inline double GetTargetFrameTime() const noexcept { return m_TargetFrameTime; }
+		inline void SetTargetFrameTime(const double seconds) noexcept { m_TargetFrameTime = seconds; }
+
+		// How far the current frame is between the last fixed step and the next one, in [0, 1).
+		// Blend the previous and current fixed step states by it when rendering
+		inline float GetInterpolationAlpha() const noexcept { return m_InterpolationAlpha; }
+
 		void Run()
 		{
 			m_IsRunning = true;
@@ -127,15 +173,16 @@ namespace Camel
 
 			OnStart();
 
-			Uint64 previousTicks = SDL_GetTicks64();
-			float deltaTime = 0.0f;
+			const double frequency = (double)SDL_GetPerformanceFrequency();
+			Uint64 previousCounter = SDL_GetPerformanceCounter();
+			double fixedAccumulator = 0.0;
 
 			while (m_IsRunning)
 			{
 				// Calculate delta time in seconds
-				Uint64 currentTicks = SDL_GetTicks64();
-				deltaTime = (float)(currentTicks - previousTicks) / 1000.0f;
-				previousTicks = currentTicks;
+				const Uint64 frameStart = SDL_GetPerformanceCounter();
+				const double deltaTime = (double)(frameStart - previousCounter) / frequency;
+				previousCounter = frameStart;
 
 				Input::Update();
 
@@ -145,22 +192,79 @@ namespace Camel
 					break;
 				}
 
+				m_AssetLoader->ProcessUploads(m_AssetUploadBudget);
+
+				// Propagate last frame's transform changes in one pass before the fixed steps, Scene::Update propagates OnUpdate's edits
+				TransformHierarchy::GetInstance().Update(m_JobSystem.get());
+
+				if (m_FixedTimeStep > 0.0)
+				{
+					// Clamped so a long stall does not turn into a burst of catch-up steps
+					fixedAccumulator += std::min(deltaTime, MAX_FRAME_TIME);
+					while (fixedAccumulator >= m_FixedTimeStep)
+					{
+						OnFixedUpdate((float)m_FixedTimeStep);
+						fixedAccumulator -= m_FixedTimeStep;
+					}
+					m_InterpolationAlpha = (float)(fixedAccumulator / m_FixedTimeStep);
+				}
+
 				glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-				OnUpdate(deltaTime);
+				OnUpdate((float)deltaTime);
 
 				SDL_GL_SwapWindow(m_Window);
+				GLState::EndFrame();
+
+				if (m_TargetFrameTime > 0.0)
+					WaitUntil(frameStart + (Uint64)(m_TargetFrameTime * frequency));
 			}
 		}
 
 		virtual void OnStart() = 0;
 		virtual void OnUpdate(float deltaTime) = 0;
 
+		// Runs zero or more times per frame before OnUpdate, every call advances the simulation by exactly fixedDeltaTime
+		virtual void OnFixedUpdate(float fixedDeltaTime) {}
+
+	private:
+		// Longest frame the fixed step catches up on
+		static constexpr double MAX_FRAME_TIME = 0.25;
+
+		// Sleeping can overshoot by a scheduler tick, the last stretch before the deadline is spent yielding instead
+		static constexpr double SPIN_TIME = 0.002;
+
+		void WaitUntil(const Uint64 deadline) const
+		{
+			const double frequency = (double)SDL_GetPerformanceFrequency();
+			while (true)
+			{
+				const Uint64 now = SDL_GetPerformanceCounter();
+				if (now >= deadline)
+					return;
+
+				const double remaining = (double)(deadline - now) / frequency;
+				if (remaining > SPIN_TIME)
+					SDL_Delay((Uint32)((remaining - SPIN_TIME) * 1000.0));
+				else
+					std::this_thread::yield();
+			}
+		}
+
 	private:
 		SDL_Window* m_Window;
 		SDL_GLContext m_Context;
 
 		bool m_IsRunning;
+
+		// Declared first so the asset loader is destroyed before the workers it submits to
+		std::unique_ptr<JobSystem> m_JobSystem;
+		std::unique_ptr<AssetLoader> m_AssetLoader;
+		double m_AssetUploadBudget;
+
+		double m_FixedTimeStep;
+		double m_TargetFrameTime;
+		float m_InterpolationAlpha;
 	};
 }
\ No newline at end of file
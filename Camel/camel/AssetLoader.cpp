@@ -0,0 +1,91 @@
+#include "AssetLoader.h"
+
+#include <chrono>
+
+namespace Camel
+{
+	AssetLoader::AssetLoader(JobSystem& jobSystem)
+		: m_JobSystem(jobSystem), m_IsStopping(false), m_PendingCount(0)
+	{}
+
+	AssetLoader::~AssetLoader() noexcept
+	{
+		Shutdown();
+	}
+
+	void AssetLoader::Shutdown() noexcept
+	{
+		// Queued decodes see the flag and return, the ones already running finish first
+		m_IsStopping.store(true, std::memory_order_relaxed);
+		m_JobSystem.Wait(m_Jobs);
+
+		// Dropping the uploads releases their payloads, assets that never made it stay LOADING
+		std::lock_guard<std::mutex> lock(m_UploadMutex);
+		m_Uploads.clear();
+		m_Polls.clear();
+	}
+
+	AssetHandle<Mesh> AssetLoader::LoadMesh(const std::string& filePath, const MeshImportSettings& settings, GeometryArena* arena)
+	{
+		return Submit<Mesh>(
+			[this, filePath, settings]() { return Mesh::Read(filePath, settings, &m_JobSystem); },
+			[arena](const MeshSource& source) { return Mesh(source, arena); });
+	}
+
+	AssetHandle<Texture> AssetLoader::LoadTexture(const std::string& filePath, const Texture::FilterMode filterMode)
+	{
+		return Submit<Texture>(
+			[filePath]() { return Texture::Decode(filePath); },
+			[filterMode](const TextureImage& image) { return Texture(image, filterMode); });
+	}
+
+	AssetHandle<Shader> AssetLoader::LoadShader(const std::string& vertexFilePath, const std::string& fragmentFilePath)
+	{
+		return Submit<Shader>(
+			[vertexFilePath, fragmentFilePath]() { return Shader::Read(vertexFilePath, fragmentFilePath); },
+			[](const ShaderSources& sources) { return Shader::CompileAsync(sources.vertex, sources.fragment); });
+	}
+
+	void AssetLoader::ProcessUploads(const double budgetSeconds)
+	{
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(budgetSeconds);
+
+		// Once per call, polling again within the same frame would only find the same work unfinished
+		std::erase_if(m_Polls, [](const std::function<bool()>& poll) { return poll(); });
+
+		do
+		{
+			std::function<void()> upload;
+			{
+				std::lock_guard<std::mutex> lock(m_UploadMutex);
+				if (m_Uploads.empty())
+					return;
+
+				upload = std::move(m_Uploads.front());
+				m_Uploads.pop_front();
+			}
+
+			upload();
+		} while (std::chrono::steady_clock::now() < deadline);
+	}
+
+	void AssetLoader::PushJob(std::function<void()> job)
+	{
+		m_JobSystem.Run([this, job = std::move(job)]()
+		{
+			if (!m_IsStopping.load(std::memory_order_relaxed))
+				job();
+		}, &m_Jobs, JobPriority::BACKGROUND);
+	}
+
+	void AssetLoader::PushUpload(std::function<void()> upload)
+	{
+		std::lock_guard<std::mutex> lock(m_UploadMutex);
+		m_Uploads.push_back(std::move(upload));
+	}
+
+	void AssetLoader::PushPoll(std::function<bool()> poll)
+	{
+		m_Polls.push_back(std::move(poll));
+	}
+}
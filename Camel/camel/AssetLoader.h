@@ -0,0 +1,207 @@
+#pragma once
+
+#include "Core.h"
+#include "JobSystem.h"
+#include "Mesh.h"
+#include "Shader.h"
+#include "Texture.h"
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace Camel
+{
+	enum class AssetStatus
+	{
+		LOADING,
+		READY,
+		FAILED,
+	};
+
+	template<typename T>
+	struct AssetState
+	{
+		std::atomic<AssetStatus> status = AssetStatus::LOADING;
+		std::optional<T> asset;
+		std::exception_ptr error;
+		bool failureReported = false; // Only touched on the GL thread
+	};
+
+	// Shared handle to an asset that is still loading. Only query it from the GL thread
+	template<typename T>
+	class AssetHandle final
+	{
+	public:
+		AssetHandle() = default;
+		explicit AssetHandle(std::shared_ptr<AssetState<T>> state) noexcept
+			: m_State(std::move(state))
+		{}
+
+		inline bool IsValid() const noexcept { return m_State != nullptr; }
+		inline AssetStatus GetStatus() const noexcept { return m_State ? m_State->status.load(std::memory_order_acquire) : AssetStatus::FAILED; }
+		inline bool IsReady() const noexcept { return GetStatus() == AssetStatus::READY; }
+
+		// True when the load failed. The failure is logged the first time any handle to the asset reports it
+		inline bool ReportFailure(const std::string_view kind) const noexcept
+		{
+			if (!m_State || m_State->status.load(std::memory_order_acquire) != AssetStatus::FAILED)
+				return false;
+
+			if (!m_State->failureReported)
+			{
+				m_State->failureReported = true;
+				try
+				{
+					std::rethrow_exception(m_State->error);
+				}
+				catch (const std::exception& e)
+				{
+					CAMEL_LOG_ERROR("Failed to load {}: {}", kind, e.what());
+				}
+				catch (...)
+				{
+					CAMEL_LOG_ERROR("Failed to load {}", kind);
+				}
+			}
+			return true;
+		}
+
+		// Rethrows the load failure, if any
+		inline T& Get() const
+		{
+			CAMEL_ASSERT(IsValid() && GetStatus() != AssetStatus::LOADING, "Asset is not loaded yet");
+
+			if (m_State->status.load(std::memory_order_acquire) == AssetStatus::FAILED)
+				std::rethrow_exception(m_State->error);
+
+			return *m_State->asset;
+		}
+
+		inline T& operator*() const { return Get(); }
+		inline T* operator->() const { return &Get(); }
+
+	private:
+		std::shared_ptr<AssetState<T>> m_State;
+	};
+
+	// Loads assets in the background. Reading and decoding run as background jobs on the job system, GL object creation is queued
+	// back to the GL thread and drained by ProcessUploads within a time budget each frame.
+	class AssetLoader final
+	{
+	public:
+		explicit AssetLoader(JobSystem& jobSystem);
+
+		AssetLoader(const AssetLoader&) = delete;
+		AssetLoader& operator=(const AssetLoader&) = delete;
+
+		~AssetLoader() noexcept;
+
+		// Meshes given an arena are uploaded into it, the arena must outlive them
+		AssetHandle<Mesh> LoadMesh(const std::string& filePath, const MeshImportSettings& settings = {}, GeometryArena* arena = nullptr);
+		AssetHandle<Texture> LoadTexture(const std::string& filePath, const Texture::FilterMode filterMode = Texture::FilterMode::LINEAR);
+		AssetHandle<Shader> LoadShader(const std::string& vertexFilePath, const std::string& fragmentFilePath);
+
+		// Polls assets the driver is still finishing, then runs queued GL uploads on the calling (GL) thread until the budget runs out.
+		// At least one upload runs per call so loading always progresses
+		void ProcessUploads(const double budgetSeconds);
+
+		// Waits for running decodes and drops pending work, must run while the GL context is still alive
+		void Shutdown() noexcept;
+
+		inline size_t GetPendingCount() const noexcept { return m_PendingCount.load(std::memory_order_relaxed); }
+
+	private:
+		// decode runs on a worker and returns the CPU side payload, create turns it into the asset on the GL thread
+		template<typename T, typename Decode, typename Create>
+		AssetHandle<T> Submit(Decode decode, Create create)
+		{
+			using Payload = decltype(decode());
+
+			auto state = std::make_shared<AssetState<T>>();
+			m_PendingCount.fetch_add(1, std::memory_order_relaxed);
+
+			PushJob([this, state, decode, create]()
+			{
+				try
+				{
+					// Shared so the upload closure stays copyable
+					auto payload = std::make_shared<Payload>(decode());
+					PushUpload([this, state, payload, create]()
+					{
+						try
+						{
+							state->asset.emplace(create(*payload));
+
+							// Assets the driver finishes in the background (shaders) stay loading until polled as done
+							if constexpr (requires(T& asset) { asset.Poll(); })
+							{
+								PushPoll([this, state]()
+								{
+									try
+									{
+										if (!state->asset->Poll())
+											return false;
+										state->status.store(AssetStatus::READY, std::memory_order_release);
+									}
+									catch (...)
+									{
+										Fail(*state, std::current_exception());
+									}
+									m_PendingCount.fetch_sub(1, std::memory_order_relaxed);
+									return true;
+								});
+								return;
+							}
+
+							state->status.store(AssetStatus::READY, std::memory_order_release);
+						}
+						catch (...)
+						{
+							Fail(*state, std::current_exception());
+						}
+						m_PendingCount.fetch_sub(1, std::memory_order_relaxed);
+					});
+				}
+				catch (...)
+				{
+					Fail(*state, std::current_exception());
+					m_PendingCount.fetch_sub(1, std::memory_order_relaxed);
+				}
+			});
+
+			return AssetHandle<T>(state);
+		}
+
+		template<typename T>
+		static void Fail(AssetState<T>& state, std::exception_ptr error) noexcept
+		{
+			state.error = error;
+			state.status.store(AssetStatus::FAILED, std::memory_order_release);
+		}
+
+		void PushJob(std::function<void()> job);
+		void PushUpload(std::function<void()> upload);
+
+		// poll returns true once done. Only called from uploads, so on the GL thread
+		void PushPoll(std::function<bool()> poll);
+
+	private:
+		JobSystem& m_JobSystem;
+		JobCounter m_Jobs;
+		std::atomic<bool> m_IsStopping;
+
+		std::mutex m_UploadMutex;
+		std::deque<std::function<void()>> m_Uploads;
+
+		std::vector<std::function<bool()>> m_Polls; // GL thread only
+
+		std::atomic<size_t> m_PendingCount;
+	};
+}
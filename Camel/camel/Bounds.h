@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Core.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Camel
+{
+	// Axis aligned box and enclosing sphere of a set of points
+	struct Bounds
+	{
+		glm::vec3 min = glm::vec3(0.0f);
+		glm::vec3 max = glm::vec3(0.0f);
+		glm::vec3 center = glm::vec3(0.0f);
+		float radius = 0.0f;
+
+		inline glm::vec3 GetExtents() const noexcept { return (max - min) * 0.5f; }
+
+		// Box enclosing the transformed box, and the sphere scaled by the largest axis scale
+		inline Bounds Transformed(const glm::mat4& matrix) const noexcept
+		{
+			const glm::vec3 boxCenter = glm::vec3(matrix * glm::vec4((min + max) * 0.5f, 1.0f));
+			const glm::vec3 extents = GetExtents();
+			const glm::vec3 transformedExtents = glm::abs(glm::vec3(matrix[0])) * extents.x + glm::abs(glm::vec3(matrix[1])) * extents.y + glm::abs(glm::vec3(matrix[2])) * extents.z;
+			const float scale = std::sqrt(std::max({ glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0])), glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1])), glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2])) }));
+
+			Bounds bounds;
+			bounds.min = boxCenter - transformedExtents;
+			bounds.max = boxCenter + transformedExtents;
+			bounds.center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+			bounds.radius = radius * scale;
+			return bounds;
+		}
+
+		// Computes bounds from count positions spaced stride bytes apart
+		static inline Bounds FromPoints(const glm::vec3* positions, const size_t count, const size_t stride = sizeof(glm::vec3)) noexcept
+		{
+			Bounds bounds;
+			if (count == 0)
+				return bounds;
+
+			bounds.min = glm::vec3(std::numeric_limits<float>::max());
+			bounds.max = glm::vec3(std::numeric_limits<float>::lowest());
+
+			const char* point = reinterpret_cast<const char*>(positions);
+			for (size_t i = 0; i < count; i++, point += stride)
+			{
+				const glm::vec3& position = *reinterpret_cast<const glm::vec3*>(point);
+				bounds.min = glm::min(bounds.min, position);
+				bounds.max = glm::max(bounds.max, position);
+			}
+
+			bounds.center = (bounds.min + bounds.max) * 0.5f;
+
+			point = reinterpret_cast<const char*>(positions);
+			float radiusSquared = 0.0f;
+			for (size_t i = 0; i < count; i++, point += stride)
+			{
+				const glm::vec3 offset = *reinterpret_cast<const glm::vec3*>(point) - bounds.center;
+				radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+			}
+			bounds.radius = std::sqrt(radiusSquared);
+
+			return bounds;
+		}
+	};
+}
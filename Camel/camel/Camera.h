@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Core.h"
+#include "Frustum.h"
 #include "Transform.h"
 
 #include <glm/glm.hpp>
@@ -60,7 +61,7 @@ namespace Camel
 		inline Transform& GetTransform() noexcept { return m_Transform; }
 		inline const Transform& GetTransform() const noexcept { return m_Transform; }
 
-		inline const glm::mat4& GetViewMatrix() const noexcept { return m_Transform.GetMatrix(); }
+		inline glm::mat4 GetViewMatrix() const noexcept { return m_Transform.GetWorldToLocalMatrix(); }
 
 		inline const glm::mat4& GetProjectionMatrix() const noexcept
 		{
@@ -73,6 +74,9 @@ namespace Camel
 			return m_ProjectionMatrix;
 		}
 
+		// World space planes of the current view
+		inline Frustum GetFrustum() const noexcept { return Frustum::FromMatrix(GetProjectionMatrix() * GetViewMatrix()); }
+
 		inline float GetFOV() const noexcept { return m_FOV; }
 		inline void SetFOV(const float fov) noexcept
 		{
@@ -107,7 +111,7 @@ namespace Camel
 		float m_NearPlane;
 		float m_FarPlane;
 
-		CameraTransform m_Transform;
+		Transform m_Transform;
 
 		mutable glm::mat4 m_ProjectionMatrix; // Lazily computed
 		mutable bool m_IsDirty; // Used to cache projection matrix and only recompute when needed
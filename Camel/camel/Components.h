@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Core.h"
+#include "AssetLoader.h"
+#include "DynamicAabbTree.h"
+
+namespace Camel
+{
+	// Draws a mesh at the Transform of its entity, needs a Material to render
+	struct MeshInstance
+	{
+		AssetHandle<Mesh> mesh;
+		uint32_t spatialProxy = DynamicAabbTree::INVALID_PROXY; // Owned by the Scene
+		Bounds worldBounds; // Owned by the Scene, the spatial index only keeps enlarged boxes
+	};
+
+	struct Material
+	{
+		AssetHandle<Shader> shader;
+		AssetHandle<Texture> diffuse;
+		glm::vec3 baseColor = glm::vec3(1.0f);
+	};
+}
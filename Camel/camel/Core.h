@@ -34,6 +34,11 @@
 
 #endif // CAMEL_DEBUG_MODE
 
+// SSE2 is the baseline on x64 and the default for MSVC x86
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define CAMEL_SIMD_SSE
+#endif
+
 /*
 Example usage:
 	CAMEL_LOG_INFO("This is an info message. Value: {}", 42);
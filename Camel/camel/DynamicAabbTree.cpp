@@ -0,0 +1,349 @@
+#include "DynamicAabbTree.h"
+
+namespace Camel
+{
+	namespace
+	{
+		// Moving leaves get their fat box stretched this many frames ahead along the displacement
+		constexpr float DISPLACEMENT_MULTIPLIER = 4.0f;
+
+		inline float SurfaceArea(const glm::vec3& min, const glm::vec3& max) noexcept
+		{
+			const glm::vec3 size = max - min;
+			return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		inline bool Contains(const glm::vec3& outerMin, const glm::vec3& outerMax, const glm::vec3& innerMin, const glm::vec3& innerMax) noexcept
+		{
+			return glm::all(glm::lessThanEqual(outerMin, innerMin)) && glm::all(glm::greaterThanEqual(outerMax, innerMax));
+		}
+	}
+
+	DynamicAabbTree::DynamicAabbTree(const float margin)
+		: m_Root(INVALID_PROXY), m_FreeList(INVALID_PROXY), m_LeafCount(0), m_Margin(margin)
+	{
+		CAMEL_ASSERT(margin >= 0.0f, "Dynamic AABB tree margin {} must not be negative.", margin);
+	}
+
+	DynamicAabbTree::DynamicAabbTree(DynamicAabbTree&& other) noexcept
+		: m_Nodes(std::move(other.m_Nodes)), m_Root(other.m_Root), m_FreeList(other.m_FreeList), m_LeafCount(other.m_LeafCount), m_Margin(other.m_Margin)
+	{
+		other.m_Root = INVALID_PROXY;
+		other.m_FreeList = INVALID_PROXY;
+		other.m_LeafCount = 0;
+	}
+
+	DynamicAabbTree& DynamicAabbTree::operator=(DynamicAabbTree&& other) noexcept
+	{
+		if (this != &other)
+		{
+			m_Nodes = std::move(other.m_Nodes);
+			m_Root = other.m_Root;
+			m_FreeList = other.m_FreeList;
+			m_LeafCount = other.m_LeafCount;
+			m_Margin = other.m_Margin;
+
+			other.m_Root = INVALID_PROXY;
+			other.m_FreeList = INVALID_PROXY;
+			other.m_LeafCount = 0;
+		}
+		return *this;
+	}
+
+	uint32_t DynamicAabbTree::Insert(const glm::vec3& min, const glm::vec3& max, const uint32_t userData)
+	{
+		const uint32_t proxy = AllocateNode();
+		Node& node = m_Nodes[proxy];
+		node.min = min - m_Margin;
+		node.max = max + m_Margin;
+		node.userData = userData;
+		node.height = 0;
+
+		InsertLeaf(proxy);
+		m_LeafCount++;
+		return proxy;
+	}
+
+	void DynamicAabbTree::Remove(const uint32_t proxy)
+	{
+		CAMEL_ASSERT(proxy < m_Nodes.size() && m_Nodes[proxy].IsLeaf() && m_Nodes[proxy].height == 0, "Invalid dynamic AABB tree proxy {}.", proxy);
+
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		m_LeafCount--;
+	}
+
+	bool DynamicAabbTree::Move(const uint32_t proxy, const glm::vec3& min, const glm::vec3& max, const glm::vec3& displacement)
+	{
+		CAMEL_ASSERT(proxy < m_Nodes.size() && m_Nodes[proxy].IsLeaf() && m_Nodes[proxy].height == 0, "Invalid dynamic AABB tree proxy {}.", proxy);
+
+		glm::vec3 fatMin = min - m_Margin;
+		glm::vec3 fatMax = max + m_Margin;
+
+		const glm::vec3 predicted = displacement * DISPLACEMENT_MULTIPLIER;
+		fatMin += glm::min(predicted, glm::vec3(0.0f));
+		fatMax += glm::max(predicted, glm::vec3(0.0f));
+
+		const Node& node = m_Nodes[proxy];
+		if (Contains(node.min, node.max, min, max))
+		{
+			// Still inside, unless the fat box has grown far larger than needed, e.g. after the object slowed down
+			const glm::vec3 hugeMin = fatMin - 4.0f * m_Margin;
+			const glm::vec3 hugeMax = fatMax + 4.0f * m_Margin;
+			if (Contains(hugeMin, hugeMax, node.min, node.max))
+				return false;
+		}
+
+		RemoveLeaf(proxy);
+		m_Nodes[proxy].min = fatMin;
+		m_Nodes[proxy].max = fatMax;
+		InsertLeaf(proxy);
+		return true;
+	}
+
+	uint32_t DynamicAabbTree::AllocateNode()
+	{
+		uint32_t index;
+		if (m_FreeList != INVALID_PROXY)
+		{
+			index = m_FreeList;
+			m_FreeList = m_Nodes[index].parent;
+		}
+		else
+		{
+			index = (uint32_t)m_Nodes.size();
+			m_Nodes.emplace_back();
+		}
+
+		Node& node = m_Nodes[index];
+		node.parent = INVALID_PROXY;
+		node.child1 = INVALID_PROXY;
+		node.child2 = INVALID_PROXY;
+		node.height = 0;
+		node.userData = 0;
+		return index;
+	}
+
+	void DynamicAabbTree::FreeNode(const uint32_t index)
+	{
+		m_Nodes[index].parent = m_FreeList;
+		m_Nodes[index].height = -1;
+		m_FreeList = index;
+	}
+
+	void DynamicAabbTree::InsertLeaf(const uint32_t leaf)
+	{
+		if (m_Root == INVALID_PROXY)
+		{
+			m_Root = leaf;
+			m_Nodes[leaf].parent = INVALID_PROXY;
+			return;
+		}
+
+		// Descend towards the sibling with the lowest surface area cost
+		const glm::vec3 leafMin = m_Nodes[leaf].min;
+		const glm::vec3 leafMax = m_Nodes[leaf].max;
+		uint32_t index = m_Root;
+		while (!m_Nodes[index].IsLeaf())
+		{
+			const Node& node = m_Nodes[index];
+			const float area = SurfaceArea(node.min, node.max);
+			const float combinedArea = SurfaceArea(glm::min(node.min, leafMin), glm::max(node.max, leafMax));
+
+			// Pairing with this node creates a parent with the combined area, descending pushes the growth to all ancestors
+			const float cost = 2.0f * combinedArea;
+			const float inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto childCost = [&](const Node& child)
+			{
+				const float childArea = SurfaceArea(glm::min(child.min, leafMin), glm::max(child.max, leafMax));
+				return (child.IsLeaf() ? childArea : childArea - SurfaceArea(child.min, child.max)) + inheritanceCost;
+			};
+
+			const float cost1 = childCost(m_Nodes[node.child1]);
+			const float cost2 = childCost(m_Nodes[node.child2]);
+			if (cost < cost1 && cost < cost2)
+				break;
+
+			index = cost1 < cost2 ? node.child1 : node.child2;
+		}
+
+		const uint32_t sibling = index;
+		const uint32_t oldParent = m_Nodes[sibling].parent;
+		const uint32_t newParent = AllocateNode();
+
+		Node& parent = m_Nodes[newParent];
+		parent.parent = oldParent;
+		parent.min = glm::min(m_Nodes[sibling].min, leafMin);
+		parent.max = glm::max(m_Nodes[sibling].max, leafMax);
+		parent.height = m_Nodes[sibling].height + 1;
+		parent.child1 = sibling;
+		parent.child2 = leaf;
+
+		if (oldParent != INVALID_PROXY)
+		{
+			if (m_Nodes[oldParent].child1 == sibling)
+				m_Nodes[oldParent].child1 = newParent;
+			else
+				m_Nodes[oldParent].child2 = newParent;
+		}
+		else
+		{
+			m_Root = newParent;
+		}
+
+		m_Nodes[sibling].parent = newParent;
+		m_Nodes[leaf].parent = newParent;
+
+		Refit(oldParent);
+	}
+
+	void DynamicAabbTree::RemoveLeaf(const uint32_t leaf)
+	{
+		if (leaf == m_Root)
+		{
+			m_Root = INVALID_PROXY;
+			return;
+		}
+
+		const uint32_t parent = m_Nodes[leaf].parent;
+		const uint32_t grandParent = m_Nodes[parent].parent;
+		const uint32_t sibling = m_Nodes[parent].child1 == leaf ? m_Nodes[parent].child2 : m_Nodes[parent].child1;
+
+		if (grandParent != INVALID_PROXY)
+		{
+			if (m_Nodes[grandParent].child1 == parent)
+				m_Nodes[grandParent].child1 = sibling;
+			else
+				m_Nodes[grandParent].child2 = sibling;
+
+			m_Nodes[sibling].parent = grandParent;
+			FreeNode(parent);
+			Refit(grandParent);
+		}
+		else
+		{
+			m_Root = sibling;
+			m_Nodes[sibling].parent = INVALID_PROXY;
+			FreeNode(parent);
+		}
+	}
+
+	void DynamicAabbTree::Refit(uint32_t index)
+	{
+		while (index != INVALID_PROXY)
+		{
+			index = Balance(index);
+
+			Node& node = m_Nodes[index];
+			const Node& child1 = m_Nodes[node.child1];
+			const Node& child2 = m_Nodes[node.child2];
+			node.height = 1 + std::max(child1.height, child2.height);
+			node.min = glm::min(child1.min, child2.min);
+			node.max = glm::max(child1.max, child2.max);
+
+			index = node.parent;
+		}
+	}
+
+	uint32_t DynamicAabbTree::Balance(const uint32_t indexA)
+	{
+		Node& a = m_Nodes[indexA];
+		if (a.IsLeaf() || a.height < 2)
+			return indexA;
+
+		const uint32_t indexB = a.child1;
+		const uint32_t indexC = a.child2;
+		Node& b = m_Nodes[indexB];
+		Node& c = m_Nodes[indexC];
+
+		const int balance = c.height - b.height;
+
+		// Rotate C up
+		if (balance > 1)
+		{
+			const uint32_t indexF = c.child1;
+			const uint32_t indexG = c.child2;
+			Node& f = m_Nodes[indexF];
+			Node& g = m_Nodes[indexG];
+
+			c.child1 = indexA;
+			c.parent = a.parent;
+			a.parent = indexC;
+
+			if (c.parent != INVALID_PROXY)
+			{
+				if (m_Nodes[c.parent].child1 == indexA)
+					m_Nodes[c.parent].child1 = indexC;
+				else
+					m_Nodes[c.parent].child2 = indexC;
+			}
+			else
+			{
+				m_Root = indexC;
+			}
+
+			// The taller grandchild stays under C, the other moves under A
+			Node& kept = f.height > g.height ? f : g;
+			const uint32_t indexKept = f.height > g.height ? indexF : indexG;
+			Node& moved = f.height > g.height ? g : f;
+			const uint32_t indexMoved = f.height > g.height ? indexG : indexF;
+
+			c.child2 = indexKept;
+			a.child2 = indexMoved;
+			moved.parent = indexA;
+
+			a.min = glm::min(b.min, moved.min);
+			a.max = glm::max(b.max, moved.max);
+			c.min = glm::min(a.min, kept.min);
+			c.max = glm::max(a.max, kept.max);
+			a.height = 1 + std::max(b.height, moved.height);
+			c.height = 1 + std::max(a.height, kept.height);
+			return indexC;
+		}
+
+		// Rotate B up
+		if (balance < -1)
+		{
+			const uint32_t indexD = b.child1;
+			const uint32_t indexE = b.child2;
+			Node& d = m_Nodes[indexD];
+			Node& e = m_Nodes[indexE];
+
+			b.child1 = indexA;
+			b.parent = a.parent;
+			a.parent = indexB;
+
+			if (b.parent != INVALID_PROXY)
+			{
+				if (m_Nodes[b.parent].child1 == indexA)
+					m_Nodes[b.parent].child1 = indexB;
+				else
+					m_Nodes[b.parent].child2 = indexB;
+			}
+			else
+			{
+				m_Root = indexB;
+			}
+
+			Node& kept = d.height > e.height ? d : e;
+			const uint32_t indexKept = d.height > e.height ? indexD : indexE;
+			Node& moved = d.height > e.height ? e : d;
+			const uint32_t indexMoved = d.height > e.height ? indexE : indexD;
+
+			b.child2 = indexKept;
+			a.child1 = indexMoved;
+			moved.parent = indexA;
+
+			a.min = glm::min(c.min, moved.min);
+			a.max = glm::max(c.max, moved.max);
+			b.min = glm::min(a.min, kept.min);
+			b.max = glm::max(a.max, kept.max);
+			a.height = 1 + std::max(c.height, moved.height);
+			b.height = 1 + std::max(a.height, kept.height);
+			return indexB;
+		}
+
+		return indexA;
+	}
+}
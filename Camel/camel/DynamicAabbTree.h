@@ -0,0 +1,269 @@
+#pragma once
+
+#include "Core.h"
+#include "Frustum.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace Camel
+{
+	// Bounding volume hierarchy over world space boxes with incremental insert, remove and move.
+	// Leaves store enlarged ("fat") boxes so objects moving a little do not touch the tree, and
+	// rotations on every insert and remove keep it balanced.
+	class DynamicAabbTree final
+	{
+	public:
+		static constexpr uint32_t INVALID_PROXY = UINT32_MAX;
+
+		// Deepest traversal the queries support, balanced trees of millions of leaves stay well below it
+		static constexpr size_t MAX_QUERY_DEPTH = 256;
+
+	public:
+		explicit DynamicAabbTree(const float margin = 0.1f);
+
+		DynamicAabbTree(const DynamicAabbTree&) = delete;
+		DynamicAabbTree& operator=(const DynamicAabbTree&) = delete;
+
+		DynamicAabbTree(DynamicAabbTree&& other) noexcept;
+		DynamicAabbTree& operator=(DynamicAabbTree&& other) noexcept;
+
+		~DynamicAabbTree() = default;
+
+		// Returns a proxy that stays valid until removed, userData is handed back by the queries
+		uint32_t Insert(const glm::vec3& min, const glm::vec3& max, const uint32_t userData);
+		void Remove(const uint32_t proxy);
+
+		// Only reinserts when the box left its fat box, displacement extends the fat box in the direction of travel.
+		// Returns true when the tree changed
+		bool Move(const uint32_t proxy, const glm::vec3& min, const glm::vec3& max, const glm::vec3& displacement = glm::vec3(0.0f));
+
+		inline uint32_t GetUserData(const uint32_t proxy) const noexcept { return m_Nodes[proxy].userData; }
+		inline const glm::vec3& GetFatMin(const uint32_t proxy) const noexcept { return m_Nodes[proxy].min; }
+		inline const glm::vec3& GetFatMax(const uint32_t proxy) const noexcept { return m_Nodes[proxy].max; }
+
+		inline size_t GetCount() const noexcept { return m_LeafCount; }
+		inline int GetHeight() const noexcept { return m_Root == INVALID_PROXY ? 0 : m_Nodes[m_Root].height; }
+
+		// Visitors are called as visitor(proxy, userData) for every leaf whose fat box passes the test.
+		// Boxes fully inside the frustum report their whole subtree without testing further
+		template<typename Visitor>
+		void QueryFrustum(const Frustum& frustum, Visitor&& visitor) const
+		{
+			QueryFrustum(frustum, visitor, visitor);
+		}
+
+		// Leaves known to be fully inside go to insideVisitor, leaves whose fat box crosses a plane to partialVisitor,
+		// their actual bounds may still be outside
+		template<typename InsideVisitor, typename PartialVisitor>
+		void QueryFrustum(const Frustum& frustum, InsideVisitor&& insideVisitor, PartialVisitor&& partialVisitor) const
+		{
+			if (m_Root == INVALID_PROXY)
+				return;
+
+			// Bit i set means the node is known to be inside plane i
+			constexpr uint32_t ALL_INSIDE = (1u << Frustum::PLANE_COUNT) - 1;
+
+			struct Entry { uint32_t node, insideMask; };
+			Entry stack[MAX_QUERY_DEPTH];
+			size_t stackSize = 0;
+			stack[stackSize++] = { m_Root, 0 };
+
+			while (stackSize > 0)
+			{
+				const Entry entry = stack[--stackSize];
+				const Node& node = m_Nodes[entry.node];
+
+				uint32_t insideMask = entry.insideMask;
+				if (insideMask != ALL_INSIDE)
+				{
+					const glm::vec3 center = (node.min + node.max) * 0.5f;
+					const glm::vec3 extents = (node.max - node.min) * 0.5f;
+
+					bool isOutside = false;
+					for (int i = 0; i < Frustum::PLANE_COUNT; i++)
+					{
+						if (insideMask & (1u << i))
+							continue;
+
+						const glm::vec4& plane = frustum.planes[i];
+						const float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+						const float radius = glm::dot(glm::abs(glm::vec3(plane)), extents);
+						if (distance < -radius)
+						{
+							isOutside = true;
+							break;
+						}
+						if (distance >= radius)
+							insideMask |= 1u << i;
+					}
+
+					if (isOutside)
+						continue;
+				}
+
+				if (insideMask == ALL_INSIDE)
+				{
+					VisitSubtree(entry.node, insideVisitor);
+					continue;
+				}
+
+				if (node.IsLeaf())
+				{
+					partialVisitor(entry.node, node.userData);
+					continue;
+				}
+
+				CAMEL_ASSERT(stackSize + 2 <= MAX_QUERY_DEPTH, "Dynamic AABB tree query exceeded the traversal depth {}", MAX_QUERY_DEPTH);
+				stack[stackSize++] = { node.child1, insideMask };
+				stack[stackSize++] = { node.child2, insideMask };
+			}
+		}
+
+		template<typename Visitor>
+		void QueryBox(const glm::vec3& min, const glm::vec3& max, Visitor&& visitor) const
+		{
+			Traverse([&min, &max](const Node& node)
+			{
+				return glm::all(glm::lessThanEqual(node.min, max)) && glm::all(glm::greaterThanEqual(node.max, min));
+			}, visitor);
+		}
+
+		template<typename Visitor>
+		void QuerySphere(const glm::vec3& center, const float radius, Visitor&& visitor) const
+		{
+			const float radiusSquared = radius * radius;
+			Traverse([&center, radiusSquared](const Node& node)
+			{
+				const glm::vec3 offset = center - glm::clamp(center, node.min, node.max);
+				return glm::dot(offset, offset) <= radiusSquared;
+			}, visitor);
+		}
+
+		// Visits leaves along the ray in no particular order. The visitor returns the distance to keep searching up to,
+		// return the hit distance to clip the ray, maxDistance to continue unchanged or 0 to stop
+		template<typename RayVisitor>
+		void Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayVisitor&& visitor) const
+		{
+			if (m_Root == INVALID_PROXY)
+				return;
+
+			const glm::vec3 inverseDirection = 1.0f / direction;
+
+			uint32_t stack[MAX_QUERY_DEPTH];
+			size_t stackSize = 0;
+			stack[stackSize++] = m_Root;
+
+			while (stackSize > 0)
+			{
+				const uint32_t index = stack[--stackSize];
+				const Node& node = m_Nodes[index];
+
+				// Slab test
+				const glm::vec3 t0 = (node.min - origin) * inverseDirection;
+				const glm::vec3 t1 = (node.max - origin) * inverseDirection;
+				const glm::vec3 tMin = glm::min(t0, t1);
+				const glm::vec3 tMax = glm::max(t0, t1);
+				const float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+				const float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+				if (enter > exit)
+					continue;
+
+				if (node.IsLeaf())
+				{
+					maxDistance = visitor(index, node.userData);
+					if (maxDistance <= 0.0f)
+						return;
+					continue;
+				}
+
+				CAMEL_ASSERT(stackSize + 2 <= MAX_QUERY_DEPTH, "Dynamic AABB tree query exceeded the traversal depth {}", MAX_QUERY_DEPTH);
+				stack[stackSize++] = node.child1;
+				stack[stackSize++] = node.child2;
+			}
+		}
+
+	private:
+		struct Node
+		{
+			glm::vec3 min;
+			glm::vec3 max;
+			uint32_t parent; // Next free node while on the free list
+			uint32_t child1;
+			uint32_t child2;
+			int height; // Leaves are 0, free nodes -1
+			uint32_t userData;
+
+			inline bool IsLeaf() const noexcept { return child1 == INVALID_PROXY; }
+		};
+
+		template<typename Test, typename Visitor>
+		void Traverse(Test&& test, Visitor& visitor) const
+		{
+			if (m_Root == INVALID_PROXY)
+				return;
+
+			uint32_t stack[MAX_QUERY_DEPTH];
+			size_t stackSize = 0;
+			stack[stackSize++] = m_Root;
+
+			while (stackSize > 0)
+			{
+				const uint32_t index = stack[--stackSize];
+				const Node& node = m_Nodes[index];
+				if (!test(node))
+					continue;
+
+				if (node.IsLeaf())
+				{
+					visitor(index, node.userData);
+					continue;
+				}
+
+				CAMEL_ASSERT(stackSize + 2 <= MAX_QUERY_DEPTH, "Dynamic AABB tree query exceeded the traversal depth {}", MAX_QUERY_DEPTH);
+				stack[stackSize++] = node.child1;
+				stack[stackSize++] = node.child2;
+			}
+		}
+
+		template<typename Visitor>
+		void VisitSubtree(const uint32_t root, Visitor& visitor) const
+		{
+			uint32_t stack[MAX_QUERY_DEPTH];
+			size_t stackSize = 0;
+			stack[stackSize++] = root;
+
+			while (stackSize > 0)
+			{
+				const Node& node = m_Nodes[stack[--stackSize]];
+				if (node.IsLeaf())
+				{
+					visitor(stack[stackSize], node.userData);
+					continue;
+				}
+
+				stack[stackSize++] = node.child1;
+				stack[stackSize++] = node.child2;
+			}
+		}
+
+		uint32_t AllocateNode();
+		void FreeNode(const uint32_t index);
+
+		void InsertLeaf(const uint32_t leaf);
+		void RemoveLeaf(const uint32_t leaf);
+
+		// Rotates the subtree at index if its children heights differ by more than one, returns the new subtree root
+		uint32_t Balance(const uint32_t index);
+
+		// Refits boxes and heights from index up to the root, balancing along the way
+		void Refit(uint32_t index);
+
+	private:
+		std::vector<Node> m_Nodes;
+		uint32_t m_Root;
+		uint32_t m_FreeList;
+		size_t m_LeafCount;
+		float m_Margin;
+	};
+}
@@ -0,0 +1,272 @@
+#include "DynamicMesh.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Camel
+{
+	namespace
+	{
+		constexpr GLbitfield PERSISTENT_MAP_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		// Fences are normally long signaled by the time a region comes around again, this only guards against runaway frames
+		constexpr GLuint64 FENCE_TIMEOUT_NANOSECONDS = 1000000000;
+	}
+
+	DynamicMesh::DynamicMesh(const size_t vertexCapacity, const size_t indexCapacity)
+		: m_VAO(0), m_VBO(0), m_IBO(0), m_VertexCapacity(vertexCapacity), m_IndexCapacity(indexCapacity),
+		m_MappedVertices(nullptr), m_MappedIndices(nullptr), m_Region(0), m_CommittedIndexCount(0), m_Fences{}
+	{
+		CAMEL_ASSERT(vertexCapacity > 0 && indexCapacity > 0, "Dynamic mesh capacities ({} vertices, {} indices) must be positive", vertexCapacity, indexCapacity);
+
+		m_Vertices.reserve(vertexCapacity);
+		m_Indices.reserve(indexCapacity);
+
+		glGenVertexArrays(1, &m_VAO);
+		glGenBuffers(1, &m_VBO);
+		glGenBuffers(1, &m_IBO);
+
+		GLState::BindVertexArray(m_VAO);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_VBO);
+		GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IBO);
+
+		if (GLEW_ARB_buffer_storage)
+		{
+			// One region per frame in flight, regions are addressed with base vertex and index offsets
+			const GLsizeiptr vertexBufferSize = FRAME_COUNT * vertexCapacity * sizeof(Vertex);
+			const GLsizeiptr indexBufferSize = FRAME_COUNT * indexCapacity * sizeof(GLuint);
+
+			glBufferStorage(GL_ARRAY_BUFFER, vertexBufferSize, nullptr, PERSISTENT_MAP_FLAGS);
+			glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, indexBufferSize, nullptr, PERSISTENT_MAP_FLAGS);
+
+			m_MappedVertices = static_cast<Vertex*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, vertexBufferSize, PERSISTENT_MAP_FLAGS));
+			m_MappedIndices = static_cast<GLuint*>(glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, indexBufferSize, PERSISTENT_MAP_FLAGS));
+
+			if (!m_MappedVertices || !m_MappedIndices)
+			{
+				GLState::BindVertexArray(0);
+				Release();
+				CAMEL_LOG_ERROR("Failed to persistently map dynamic mesh buffers ({} vertices, {} indices)", vertexCapacity, indexCapacity);
+				throw std::runtime_error("Failed to persistently map dynamic mesh buffers");
+			}
+		}
+		else
+		{
+			glBufferData(GL_ARRAY_BUFFER, vertexCapacity * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * sizeof(GLuint), nullptr, GL_STREAM_DRAW);
+		}
+
+		VertexLayout::Get(VertexFormat::STANDARD).Apply();
+
+		GLState::BindVertexArray(0);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	DynamicMesh::DynamicMesh(DynamicMesh&& other) noexcept
+		: m_VAO(other.m_VAO), m_VBO(other.m_VBO), m_IBO(other.m_IBO), m_VertexCapacity(other.m_VertexCapacity), m_IndexCapacity(other.m_IndexCapacity),
+		m_Vertices(std::move(other.m_Vertices)), m_Indices(std::move(other.m_Indices)), m_MappedVertices(other.m_MappedVertices), m_MappedIndices(other.m_MappedIndices),
+		m_Region(other.m_Region), m_CommittedIndexCount(other.m_CommittedIndexCount)
+	{
+		for (unsigned int region = 0; region < FRAME_COUNT; region++)
+		{
+			m_DirtyVertices[region] = other.m_DirtyVertices[region];
+			m_DirtyIndices[region] = other.m_DirtyIndices[region];
+			m_Fences[region] = other.m_Fences[region];
+			other.m_Fences[region] = nullptr;
+		}
+
+		other.m_VAO = 0;
+		other.m_VBO = 0;
+		other.m_IBO = 0;
+		other.m_MappedVertices = nullptr;
+		other.m_MappedIndices = nullptr;
+		other.m_CommittedIndexCount = 0;
+	}
+
+	DynamicMesh& DynamicMesh::operator=(DynamicMesh&& other) noexcept
+	{
+		if (this != &other)
+		{
+			// Release any resources we're holding
+			Release();
+
+			// Transfer ownership of other's resources to this
+			m_VAO = other.m_VAO;
+			m_VBO = other.m_VBO;
+			m_IBO = other.m_IBO;
+			m_VertexCapacity = other.m_VertexCapacity;
+			m_IndexCapacity = other.m_IndexCapacity;
+			m_Vertices = std::move(other.m_Vertices);
+			m_Indices = std::move(other.m_Indices);
+			m_MappedVertices = other.m_MappedVertices;
+			m_MappedIndices = other.m_MappedIndices;
+			m_Region = other.m_Region;
+			m_CommittedIndexCount = other.m_CommittedIndexCount;
+
+			for (unsigned int region = 0; region < FRAME_COUNT; region++)
+			{
+				m_DirtyVertices[region] = other.m_DirtyVertices[region];
+				m_DirtyIndices[region] = other.m_DirtyIndices[region];
+				m_Fences[region] = other.m_Fences[region];
+				other.m_Fences[region] = nullptr;
+			}
+
+			// Leave other in a safely destructible state
+			other.m_VAO = 0;
+			other.m_VBO = 0;
+			other.m_IBO = 0;
+			other.m_MappedVertices = nullptr;
+			other.m_MappedIndices = nullptr;
+			other.m_CommittedIndexCount = 0;
+		}
+		return *this;
+	}
+
+	DynamicMesh::~DynamicMesh() noexcept
+	{
+		Release();
+	}
+
+	void DynamicMesh::Release() noexcept
+	{
+		for (GLsync& fence : m_Fences)
+		{
+			if (fence)
+				glDeleteSync(fence);
+			fence = nullptr;
+		}
+
+		// Deleting a buffer also unmaps it
+		GLState::DeleteVertexArray(m_VAO);
+		GLState::DeleteBuffer(m_VBO);
+		GLState::DeleteBuffer(m_IBO);
+
+		m_VAO = m_VBO = m_IBO = 0;
+		m_MappedVertices = nullptr;
+		m_MappedIndices = nullptr;
+	}
+
+	void DynamicMesh::SetVertices(const size_t offset, std::span<const Vertex> vertices) noexcept
+	{
+		CAMEL_ASSERT(offset + vertices.size() <= m_VertexCapacity, "Writing vertices [{}, {}) past the dynamic mesh capacity {}", offset, offset + vertices.size(), m_VertexCapacity);
+
+		if (offset + vertices.size() > m_Vertices.size())
+			m_Vertices.resize(offset + vertices.size());
+
+		std::copy(vertices.begin(), vertices.end(), m_Vertices.begin() + offset);
+		MarkDirty(m_DirtyVertices, offset, offset + vertices.size());
+	}
+
+	void DynamicMesh::SetIndices(const size_t offset, std::span<const GLuint> indices) noexcept
+	{
+		CAMEL_ASSERT(offset + indices.size() <= m_IndexCapacity, "Writing indices [{}, {}) past the dynamic mesh capacity {}", offset, offset + indices.size(), m_IndexCapacity);
+
+		if (offset + indices.size() > m_Indices.size())
+			m_Indices.resize(offset + indices.size());
+
+		std::copy(indices.begin(), indices.end(), m_Indices.begin() + offset);
+		MarkDirty(m_DirtyIndices, offset, offset + indices.size());
+	}
+
+	void DynamicMesh::Resize(const size_t vertexCount, const size_t indexCount) noexcept
+	{
+		CAMEL_ASSERT(vertexCount <= m_VertexCapacity && indexCount <= m_IndexCapacity, "Resizing dynamic mesh to {} vertices and {} indices exceeds its capacity", vertexCount, indexCount);
+
+		if (vertexCount > m_Vertices.size())
+			MarkDirty(m_DirtyVertices, m_Vertices.size(), vertexCount);
+		if (indexCount > m_Indices.size())
+			MarkDirty(m_DirtyIndices, m_Indices.size(), indexCount);
+
+		m_Vertices.resize(vertexCount, Vertex{});
+		m_Indices.resize(indexCount, 0);
+	}
+
+	void DynamicMesh::MarkDirty(DirtyRange (&ranges)[FRAME_COUNT], const size_t first, const size_t last) noexcept
+	{
+		// Every region has to catch up on the change the next time it is written
+		for (DirtyRange& range : ranges)
+			range.Add(first, last);
+	}
+
+	void DynamicMesh::WaitForRegion(const unsigned int region) noexcept
+	{
+		GLsync& fence = m_Fences[region];
+		if (!fence)
+			return;
+
+		GLenum result = glClientWaitSync(fence, 0, 0);
+		while (result == GL_TIMEOUT_EXPIRED)
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NANOSECONDS);
+
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	void DynamicMesh::Commit() noexcept
+	{
+		if (IsPersistentlyMapped())
+		{
+			m_Region = (m_Region + 1) % FRAME_COUNT;
+			WaitForRegion(m_Region);
+
+			// Only the used part of the dirty range has to reach the region, elements past the end are rewritten when they come back
+			DirtyRange& vertices = m_DirtyVertices[m_Region];
+			vertices.end = std::min(vertices.end, m_Vertices.size());
+			if (!vertices.IsEmpty())
+				std::memcpy(m_MappedVertices + m_Region * m_VertexCapacity + vertices.begin, m_Vertices.data() + vertices.begin, (vertices.end - vertices.begin) * sizeof(Vertex));
+
+			DirtyRange& indices = m_DirtyIndices[m_Region];
+			indices.end = std::min(indices.end, m_Indices.size());
+			if (!indices.IsEmpty())
+				std::memcpy(m_MappedIndices + m_Region * m_IndexCapacity + indices.begin, m_Indices.data() + indices.begin, (indices.end - indices.begin) * sizeof(GLuint));
+
+			vertices = {};
+			indices = {};
+		}
+		else
+		{
+			// Orphaning gives a fresh allocation, so the whole used range is uploaded whenever anything changed
+			if (!m_DirtyVertices[0].IsEmpty())
+			{
+				GLState::BindBuffer(GL_ARRAY_BUFFER, m_VBO);
+				glBufferData(GL_ARRAY_BUFFER, m_VertexCapacity * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+				glBufferSubData(GL_ARRAY_BUFFER, 0, m_Vertices.size() * sizeof(Vertex), m_Vertices.data());
+				GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+			}
+
+			if (!m_DirtyIndices[0].IsEmpty())
+			{
+				GLState::BindVertexArray(m_VAO);
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_IndexCapacity * sizeof(GLuint), nullptr, GL_STREAM_DRAW);
+				glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, m_Indices.size() * sizeof(GLuint), m_Indices.data());
+				GLState::BindVertexArray(0);
+			}
+
+			for (unsigned int region = 0; region < FRAME_COUNT; region++)
+			{
+				m_DirtyVertices[region] = {};
+				m_DirtyIndices[region] = {};
+			}
+		}
+
+		m_CommittedIndexCount = (GLsizei)m_Indices.size();
+	}
+
+	void DynamicMesh::Draw() const noexcept
+	{
+		if (m_CommittedIndexCount == 0)
+			return;
+
+		GLState::BindVertexArray(m_VAO);
+		glDrawElementsBaseVertex(GL_TRIANGLES, m_CommittedIndexCount, GL_UNSIGNED_INT,
+			(const void*)(m_Region * m_IndexCapacity * sizeof(GLuint)), (GLint)(m_Region * m_VertexCapacity));
+
+		// The region may not be rewritten until the GPU is done with this draw
+		if (IsPersistentlyMapped())
+		{
+			if (m_Fences[m_Region])
+				glDeleteSync(m_Fences[m_Region]);
+			m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+	}
+}
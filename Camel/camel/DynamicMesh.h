@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Core.h"
+#include "GLState.h"
+#include "VertexLayout.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Camel
+{
+	// Mesh whose vertices and indices can change every frame. Writes go to a CPU copy and Commit uploads only the
+	// changed ranges into one of FRAME_COUNT buffer regions, fenced so the GPU is never stalled on data it still reads.
+	// Uses persistently mapped storage when ARB_buffer_storage is available and buffer orphaning otherwise.
+	class DynamicMesh final
+	{
+	public:
+		static constexpr unsigned int FRAME_COUNT = 3;
+
+	public:
+		DynamicMesh(const size_t vertexCapacity, const size_t indexCapacity);
+
+		DynamicMesh(const DynamicMesh&) = delete;
+		DynamicMesh& operator=(const DynamicMesh&) = delete;
+
+		DynamicMesh(DynamicMesh&& other) noexcept;
+		DynamicMesh& operator=(DynamicMesh&& other) noexcept;
+
+		~DynamicMesh() noexcept;
+
+		// Writes vertices starting at offset, growing the vertex count when writing past it
+		void SetVertices(const size_t offset, std::span<const Vertex> vertices) noexcept;
+
+		// Writes indices starting at offset, growing the index count when writing past it
+		void SetIndices(const size_t offset, std::span<const GLuint> indices) noexcept;
+
+		// Shrinks or grows the used part of the buffers, new elements are zeroed
+		void Resize(const size_t vertexCount, const size_t indexCount) noexcept;
+
+		// Uploads pending changes into the next region, call once per frame before drawing
+		void Commit() noexcept;
+
+		void Draw() const noexcept;
+
+		inline std::span<const Vertex> GetVertices() const noexcept { return m_Vertices; }
+		inline std::span<const GLuint> GetIndices() const noexcept { return m_Indices; }
+
+		inline size_t GetVertexCapacity() const noexcept { return m_VertexCapacity; }
+		inline size_t GetIndexCapacity() const noexcept { return m_IndexCapacity; }
+
+		inline bool IsPersistentlyMapped() const noexcept { return m_MappedVertices != nullptr; }
+
+	private:
+		// Half open range of elements not yet uploaded to a region
+		struct DirtyRange
+		{
+			size_t begin = SIZE_MAX;
+			size_t end = 0;
+
+			inline void Add(const size_t first, const size_t last) noexcept
+			{
+				begin = std::min(begin, first);
+				end = std::max(end, last);
+			}
+
+			inline bool IsEmpty() const noexcept { return begin >= end; }
+		};
+
+		void MarkDirty(DirtyRange (&ranges)[FRAME_COUNT], const size_t first, const size_t last) noexcept;
+		void WaitForRegion(const unsigned int region) noexcept;
+		void Release() noexcept;
+
+	private:
+		GLuint m_VAO, m_VBO, m_IBO;
+		size_t m_VertexCapacity, m_IndexCapacity;
+
+		// CPU copy, the source of every upload
+		std::vector<Vertex> m_Vertices;
+		std::vector<GLuint> m_Indices;
+
+		// Persistent mappings of the whole buffers, null when orphaning
+		Vertex* m_MappedVertices;
+		GLuint* m_MappedIndices;
+
+		unsigned int m_Region;
+		GLsizei m_CommittedIndexCount;
+		DirtyRange m_DirtyVertices[FRAME_COUNT];
+		DirtyRange m_DirtyIndices[FRAME_COUNT];
+		mutable GLsync m_Fences[FRAME_COUNT];
+	};
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Core.h"
+
+#include <glm/glm.hpp>
+
+namespace Camel
+{
+	// Six inward facing planes (normal, distance), in the space of the matrix they were extracted from
+	struct Frustum
+	{
+		enum Plane
+		{
+			LEFT_PLANE,
+			RIGHT_PLANE,
+			BOTTOM_PLANE,
+			TOP_PLANE,
+			NEAR_PLANE,
+			FAR_PLANE,
+			PLANE_COUNT,
+		};
+
+		glm::vec4 planes[PLANE_COUNT];
+
+		// Gribb-Hartmann extraction. Passing projection * view gives world space planes,
+		// projection * view * model gives model space planes
+		static inline Frustum FromMatrix(const glm::mat4& matrix) noexcept
+		{
+			const glm::vec4 row0(matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]);
+			const glm::vec4 row1(matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]);
+			const glm::vec4 row2(matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]);
+			const glm::vec4 row3(matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]);
+
+			Frustum frustum;
+			frustum.planes[LEFT_PLANE] = row3 + row0;
+			frustum.planes[RIGHT_PLANE] = row3 - row0;
+			frustum.planes[BOTTOM_PLANE] = row3 + row1;
+			frustum.planes[TOP_PLANE] = row3 - row1;
+			frustum.planes[NEAR_PLANE] = row3 + row2;
+			frustum.planes[FAR_PLANE] = row3 - row2;
+
+			// Normalize so plane distances are real distances
+			for (glm::vec4& plane : frustum.planes)
+				plane /= glm::length(glm::vec3(plane));
+
+			return frustum;
+		}
+
+		inline bool IsSphereVisible(const glm::vec3& center, const float radius) const noexcept
+		{
+			for (const glm::vec4& plane : planes)
+			{
+				if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+					return false;
+			}
+			return true;
+		}
+
+		// Conservative, boxes straddling two planes near a corner may pass
+		inline bool IsBoxVisible(const glm::vec3& center, const glm::vec3& extents) const noexcept
+		{
+			for (const glm::vec4& plane : planes)
+			{
+				if (glm::dot(glm::vec3(plane), center) + plane.w < -glm::dot(glm::abs(glm::vec3(plane)), extents))
+					return false;
+			}
+			return true;
+		}
+	};
+}
@@ -0,0 +1,175 @@
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+
+#include <cmath>
+
+#ifdef CAMEL_SIMD_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Camel
+{
+#ifdef CAMEL_SIMD_SSE
+	namespace
+	{
+		// Plane components broadcast across all four lanes
+		struct WidePlanes
+		{
+			__m128 x[Frustum::PLANE_COUNT];
+			__m128 y[Frustum::PLANE_COUNT];
+			__m128 z[Frustum::PLANE_COUNT];
+			__m128 w[Frustum::PLANE_COUNT];
+
+			WidePlanes(const Frustum& frustum, const bool absolute) noexcept
+			{
+				for (int i = 0; i < Frustum::PLANE_COUNT; i++)
+				{
+					const glm::vec4& plane = frustum.planes[i];
+					x[i] = _mm_set1_ps(absolute ? std::abs(plane.x) : plane.x);
+					y[i] = _mm_set1_ps(absolute ? std::abs(plane.y) : plane.y);
+					z[i] = _mm_set1_ps(absolute ? std::abs(plane.z) : plane.z);
+					w[i] = _mm_set1_ps(plane.w);
+				}
+			}
+		};
+
+		inline void AppendVisible(const int mask, const size_t first, std::vector<uint32_t>& visible)
+		{
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if (mask & (1 << lane))
+					visible.push_back((uint32_t)(first + lane));
+			}
+		}
+	}
+#endif
+
+	namespace
+	{
+		// Appends the visible indices in [begin, end)
+		void CullSpheresRange(const Frustum& frustum, const glm::vec4* spheres, const size_t begin, const size_t end, std::vector<uint32_t>& visible)
+		{
+			size_t i = begin;
+
+#ifdef CAMEL_SIMD_SSE
+			const WidePlanes planes(frustum, false);
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+
+			for (; i + 4 <= end; i += 4)
+			{
+				__m128 x = _mm_loadu_ps(&spheres[i + 0][0]);
+				__m128 y = _mm_loadu_ps(&spheres[i + 1][0]);
+				__m128 z = _mm_loadu_ps(&spheres[i + 2][0]);
+				__m128 radius = _mm_loadu_ps(&spheres[i + 3][0]);
+				_MM_TRANSPOSE4_PS(x, y, z, radius);
+
+				const __m128 negativeRadius = _mm_xor_ps(radius, signMask);
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (int p = 0; p < Frustum::PLANE_COUNT; p++)
+				{
+					const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes.x[p], x), _mm_mul_ps(planes.y[p], y)), _mm_add_ps(_mm_mul_ps(planes.z[p], z), planes.w[p]));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+				}
+
+				const int mask = _mm_movemask_ps(inside);
+				if (mask)
+					AppendVisible(mask, i, visible);
+			}
+#endif
+
+			for (; i < end; i++)
+			{
+				if (frustum.IsSphereVisible(glm::vec3(spheres[i]), spheres[i].w))
+					visible.push_back((uint32_t)i);
+			}
+		}
+
+		void CullBoxesRange(const Frustum& frustum, const glm::vec3* centers, const glm::vec3* extents, const size_t begin, const size_t end, std::vector<uint32_t>& visible)
+		{
+			size_t i = begin;
+
+#ifdef CAMEL_SIMD_SSE
+			const WidePlanes planes(frustum, false);
+			const WidePlanes absolutePlanes(frustum, true);
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+
+			for (; i + 4 <= end; i += 4)
+			{
+				const __m128 cx = _mm_setr_ps(centers[i].x, centers[i + 1].x, centers[i + 2].x, centers[i + 3].x);
+				const __m128 cy = _mm_setr_ps(centers[i].y, centers[i + 1].y, centers[i + 2].y, centers[i + 3].y);
+				const __m128 cz = _mm_setr_ps(centers[i].z, centers[i + 1].z, centers[i + 2].z, centers[i + 3].z);
+				const __m128 ex = _mm_setr_ps(extents[i].x, extents[i + 1].x, extents[i + 2].x, extents[i + 3].x);
+				const __m128 ey = _mm_setr_ps(extents[i].y, extents[i + 1].y, extents[i + 2].y, extents[i + 3].y);
+				const __m128 ez = _mm_setr_ps(extents[i].z, extents[i + 1].z, extents[i + 2].z, extents[i + 3].z);
+
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (int p = 0; p < Frustum::PLANE_COUNT; p++)
+				{
+					const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes.x[p], cx), _mm_mul_ps(planes.y[p], cy)), _mm_add_ps(_mm_mul_ps(planes.z[p], cz), planes.w[p]));
+					// Projected half size of the box onto the plane normal
+					const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absolutePlanes.x[p], ex), _mm_mul_ps(absolutePlanes.y[p], ey)), _mm_mul_ps(absolutePlanes.z[p], ez));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_xor_ps(radius, signMask)));
+				}
+
+				const int mask = _mm_movemask_ps(inside);
+				if (mask)
+					AppendVisible(mask, i, visible);
+			}
+#endif
+
+			for (; i < end; i++)
+			{
+				if (frustum.IsBoxVisible(centers[i], extents[i]))
+					visible.push_back((uint32_t)i);
+			}
+		}
+
+		// Culls batches into their own lists in parallel, then joins them in order
+		template<typename CullRange>
+		void CullParallel(JobSystem& jobSystem, const size_t count, std::vector<uint32_t>& visible, CullRange&& cullRange)
+		{
+			std::vector<std::vector<uint32_t>> batches((count + FrustumCuller::BATCH_SIZE - 1) / FrustumCuller::BATCH_SIZE);
+			jobSystem.ParallelFor(count, FrustumCuller::BATCH_SIZE, [&batches, &cullRange](const size_t begin, const size_t end)
+			{
+				cullRange(begin, end, batches[begin / FrustumCuller::BATCH_SIZE]);
+			});
+
+			for (const std::vector<uint32_t>& batch : batches)
+				visible.insert(visible.end(), batch.begin(), batch.end());
+		}
+	}
+
+	size_t FrustumCuller::CullSpheres(const Frustum& frustum, const glm::vec4* spheres, const size_t count, std::vector<uint32_t>& visible, JobSystem* jobSystem)
+	{
+		visible.clear();
+
+		auto cullRange = [&frustum, spheres](const size_t begin, const size_t end, std::vector<uint32_t>& batch)
+		{
+			CullSpheresRange(frustum, spheres, begin, end, batch);
+		};
+
+		if (jobSystem && count > BATCH_SIZE)
+			CullParallel(*jobSystem, count, visible, cullRange);
+		else
+			cullRange(0, count, visible);
+
+		return visible.size();
+	}
+
+	size_t FrustumCuller::CullBoxes(const Frustum& frustum, const glm::vec3* centers, const glm::vec3* extents, const size_t count, std::vector<uint32_t>& visible, JobSystem* jobSystem)
+	{
+		visible.clear();
+
+		auto cullRange = [&frustum, centers, extents](const size_t begin, const size_t end, std::vector<uint32_t>& batch)
+		{
+			CullBoxesRange(frustum, centers, extents, begin, end, batch);
+		};
+
+		if (jobSystem && count > BATCH_SIZE)
+			CullParallel(*jobSystem, count, visible, cullRange);
+		else
+			cullRange(0, count, visible);
+
+		return visible.size();
+	}
+}
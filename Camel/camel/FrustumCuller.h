@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Core.h"
+#include "Frustum.h"
+
+#include <vector>
+
+namespace Camel
+{
+	class JobSystem;
+
+	// Tests arrays of world space bounds against a frustum four at a time, writing the indices of the visible ones
+	class FrustumCuller final
+	{
+	public:
+		// Large arrays are split into batches of this many over the job system, when one is given
+		static constexpr size_t BATCH_SIZE = 4096;
+
+		// Spheres hold their center in xyz and radius in w
+		static size_t CullSpheres(const Frustum& frustum, const glm::vec4* spheres, const size_t count, std::vector<uint32_t>& visible, JobSystem* jobSystem = nullptr);
+
+		// Boxes are given as center and half size, see Bounds::GetExtents
+		static size_t CullBoxes(const Frustum& frustum, const glm::vec3* centers, const glm::vec3* extents, const size_t count, std::vector<uint32_t>& visible, JobSystem* jobSystem = nullptr);
+
+	public:
+		FrustumCuller() = delete;
+	};
+}
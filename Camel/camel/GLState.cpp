@@ -0,0 +1,120 @@
+#include "GLState.h"
+
+namespace Camel
+{
+	GLState::State::State() noexcept
+	{
+		program = UNKNOWN;
+		vertexArray = UNKNOWN;
+		activeUnit = UNKNOWN;
+		textures.fill(UNKNOWN);
+		buffers.fill(UNKNOWN);
+		uniformBindings.fill(UNKNOWN);
+		blend = depthTest = cullFace = depthMask = UNKNOWN;
+		blendFunc = UNKNOWN;
+		polygonMode = UNKNOWN;
+	}
+
+	void GLState::BindBufferBase(const GLenum target, const GLuint index, const GLuint buffer) noexcept
+	{
+		if (target != GL_UNIFORM_BUFFER || index >= UNIFORM_BINDING_COUNT)
+		{
+			s_State.stats.issued++;
+			glBindBufferBase(target, index, buffer);
+
+			const size_t slot = GetBufferSlot(target);
+			if (slot != UNTRACKED)
+				s_State.buffers[slot] = buffer;
+			return;
+		}
+
+		if (Track(s_State.uniformBindings[index], buffer))
+		{
+			glBindBufferBase(target, index, buffer);
+			s_State.buffers[UNIFORM_BUFFER_SLOT] = buffer;
+		}
+	}
+
+	void GLState::SetEnabled(const GLenum capability, const bool isEnabled) noexcept
+	{
+		GLuint* current = nullptr;
+		switch (capability)
+		{
+		case GL_BLEND: current = &s_State.blend; break;
+		case GL_DEPTH_TEST: current = &s_State.depthTest; break;
+		case GL_CULL_FACE: current = &s_State.cullFace; break;
+		}
+
+		if (current && !Track(*current, (GLuint)isEnabled))
+			return;
+
+		if (!current)
+			s_State.stats.issued++;
+
+		if (isEnabled)
+			glEnable(capability);
+		else
+			glDisable(capability);
+	}
+
+	void GLState::DeleteProgram(const GLuint program) noexcept
+	{
+		// A program in use is only flagged for deletion and stays current, but its name must not match a later one
+		if (program != 0 && s_State.program == program)
+			s_State.program = UNKNOWN;
+
+		glDeleteProgram(program);
+	}
+
+	void GLState::DeleteVertexArray(const GLuint vertexArray) noexcept
+	{
+		if (vertexArray != 0 && s_State.vertexArray == vertexArray)
+			s_State.vertexArray = 0;
+
+		glDeleteVertexArrays(1, &vertexArray);
+	}
+
+	void GLState::DeleteBuffer(const GLuint buffer) noexcept
+	{
+		if (buffer != 0)
+		{
+			for (GLuint& binding : s_State.buffers)
+				if (binding == buffer)
+					binding = 0;
+
+			for (GLuint& binding : s_State.uniformBindings)
+				if (binding == buffer)
+					binding = 0;
+		}
+
+		glDeleteBuffers(1, &buffer);
+	}
+
+	void GLState::DeleteTexture(const GLuint texture) noexcept
+	{
+		if (texture != 0)
+		{
+			for (GLuint& binding : s_State.textures)
+				if (binding == texture)
+					binding = 0;
+		}
+
+		glDeleteTextures(1, &texture);
+	}
+
+	void GLState::Invalidate() noexcept
+	{
+		const GLStateStats stats = s_State.stats;
+		const GLStateStats lastFrameStats = s_State.lastFrameStats;
+
+		s_State = State();
+		s_State.stats = stats;
+		s_State.lastFrameStats = lastFrameStats;
+	}
+
+	void GLState::EndFrame() noexcept
+	{
+		s_State.lastFrameStats = s_State.stats;
+		s_State.stats = {};
+	}
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Core.h"
+
+#include <array>
+
+namespace Camel
+{
+	struct GLStateStats
+	{
+		size_t issued = 0; // State changes that reached the driver
+		size_t skipped = 0; // Redundant ones filtered out
+	};
+
+	// Shadow copy of the GL state the engine changes, so setting what is already set makes no GL call. Everything that
+	// binds, toggles or deletes this state has to go through here, call Invalidate after code that uses GL directly.
+	// Element array buffer bindings belong to the vertex array and are passed through. GL thread only
+	class GLState final
+	{
+	public:
+		static constexpr GLuint TEXTURE_UNIT_COUNT = 32;
+		static constexpr GLuint UNIFORM_BINDING_COUNT = 16;
+
+		static inline void UseProgram(const GLuint program) noexcept
+		{
+			if (Track(s_State.program, program))
+				glUseProgram(program);
+		}
+
+		static inline void BindVertexArray(const GLuint vertexArray) noexcept
+		{
+			if (Track(s_State.vertexArray, vertexArray))
+				glBindVertexArray(vertexArray);
+		}
+
+		// Binds a GL_TEXTURE_2D and leaves its unit active, so glTex* calls that follow apply to it
+		static inline void BindTexture(const GLuint unit, const GLuint texture) noexcept
+		{
+			CAMEL_ASSERT(unit < TEXTURE_UNIT_COUNT, "Cannot bind texture to unit {}. Acceptable values are 0 to {}.", unit, TEXTURE_UNIT_COUNT - 1);
+
+			if (Track(s_State.activeUnit, unit))
+				glActiveTexture(GL_TEXTURE0 + unit);
+
+			if (Track(s_State.textures[unit], texture))
+				glBindTexture(GL_TEXTURE_2D, texture);
+		}
+
+		static inline void BindBuffer(const GLenum target, const GLuint buffer) noexcept
+		{
+			const size_t slot = GetBufferSlot(target);
+			if (slot == UNTRACKED)
+			{
+				s_State.stats.issued++;
+				glBindBuffer(target, buffer);
+				return;
+			}
+
+			if (Track(s_State.buffers[slot], buffer))
+				glBindBuffer(target, buffer);
+		}
+
+		// Also binds the buffer to the generic target, as GL does
+		static void BindBufferBase(const GLenum target, const GLuint index, const GLuint buffer) noexcept;
+
+		// GL_BLEND, GL_DEPTH_TEST and GL_CULL_FACE are tracked, other capabilities are passed through
+		static void SetEnabled(const GLenum capability, const bool isEnabled) noexcept;
+
+		static inline void SetDepthMask(const bool isWritable) noexcept
+		{
+			if (Track(s_State.depthMask, (GLuint)isWritable))
+				glDepthMask(isWritable ? GL_TRUE : GL_FALSE);
+		}
+
+		static inline void SetBlendFunc(const GLenum source, const GLenum destination) noexcept
+		{
+			// Blend factors fit in 16 bits, so both are tracked as one value
+			if (Track(s_State.blendFunc, (source << 16) | destination))
+				glBlendFunc(source, destination);
+		}
+
+		// Applies to front and back faces
+		static inline void SetPolygonMode(const GLenum mode) noexcept
+		{
+			if (Track(s_State.polygonMode, mode))
+				glPolygonMode(GL_FRONT_AND_BACK, mode);
+		}
+
+		// Deleting a bound object unbinds it, these keep the shadow state in step
+		static void DeleteProgram(const GLuint program) noexcept;
+		static void DeleteVertexArray(const GLuint vertexArray) noexcept;
+		static void DeleteBuffer(const GLuint buffer) noexcept;
+		static void DeleteTexture(const GLuint texture) noexcept;
+
+		// Forgets everything, the next call of each kind reaches the driver
+		static void Invalidate() noexcept;
+
+		// Call once per frame, the counters restart and the finished frame's become GetFrameStats
+		static void EndFrame() noexcept;
+		static inline const GLStateStats& GetFrameStats() noexcept { return s_State.lastFrameStats; }
+
+		// Counters of the frame in progress
+		static inline const GLStateStats& GetStats() noexcept { return s_State.stats; }
+
+	private:
+		static constexpr GLuint UNKNOWN = 0xFFFFFFFF;
+		static constexpr size_t UNTRACKED = SIZE_MAX;
+
+		// GL_ARRAY_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, GL_DRAW_INDIRECT_BUFFER, GL_UNIFORM_BUFFER
+		static constexpr size_t BUFFER_SLOT_COUNT = 5;
+		static constexpr size_t UNIFORM_BUFFER_SLOT = 4;
+
+		struct State
+		{
+			State() noexcept;
+
+			GLuint program;
+			GLuint vertexArray;
+			GLuint activeUnit;
+			std::array<GLuint, TEXTURE_UNIT_COUNT> textures;
+			std::array<GLuint, BUFFER_SLOT_COUNT> buffers;
+			std::array<GLuint, UNIFORM_BINDING_COUNT> uniformBindings;
+			GLuint blend, depthTest, cullFace, depthMask;
+			GLuint blendFunc;
+			GLenum polygonMode;
+
+			GLStateStats stats;
+			GLStateStats lastFrameStats;
+		};
+
+		static inline size_t GetBufferSlot(const GLenum target) noexcept
+		{
+			switch (target)
+			{
+			case GL_ARRAY_BUFFER: return 0;
+			case GL_COPY_READ_BUFFER: return 1;
+			case GL_COPY_WRITE_BUFFER: return 2;
+			case GL_DRAW_INDIRECT_BUFFER: return 3;
+			case GL_UNIFORM_BUFFER: return UNIFORM_BUFFER_SLOT;
+			default: return UNTRACKED;
+			}
+		}
+
+		// Records value and returns whether it differs from what is set
+		static inline bool Track(GLuint& current, const GLuint value) noexcept
+		{
+			if (current == value)
+			{
+				s_State.stats.skipped++;
+				return false;
+			}
+
+			current = value;
+			s_State.stats.issued++;
+			return true;
+		}
+
+	private:
+		static inline State s_State;
+
+	public:
+		GLState() = delete;
+	};
+}
@@ -0,0 +1,251 @@
+#include "GeometryArena.h"
+
+#include <algorithm>
+
+namespace Camel
+{
+	namespace
+	{
+		// Marks freed allocation slots
+		constexpr GLint FREED_BASE_VERTEX = -1;
+	}
+
+	GeometryArena::GeometryArena(const VertexLayout& layout, const size_t vertexCapacity, const size_t indexCapacity)
+		: m_Layout(layout), m_VAO(0), m_VBO(0), m_IBO(0), m_IndirectBuffer(0), m_VertexCapacity(0), m_IndexCapacity(0),
+		m_HasIndirectDraw(GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance)
+	{
+		CAMEL_ASSERT(vertexCapacity > 0 && indexCapacity > 0, "Geometry arena capacities ({} vertices, {} indices) must be positive", vertexCapacity, indexCapacity);
+
+		glGenVertexArrays(1, &m_VAO);
+		if (m_HasIndirectDraw)
+			glGenBuffers(1, &m_IndirectBuffer);
+
+		Reallocate(vertexCapacity, indexCapacity);
+	}
+
+	GeometryArena::~GeometryArena() noexcept
+	{
+		GLState::DeleteVertexArray(m_VAO);
+		GLState::DeleteBuffer(m_VBO);
+		GLState::DeleteBuffer(m_IBO);
+		GLState::DeleteBuffer(m_IndirectBuffer);
+	}
+
+	uint32_t GeometryArena::Allocate(const void* vertexData, const size_t vertexCount, const GLuint* indices, const size_t indexCount)
+	{
+		CAMEL_ASSERT(vertexCount > 0 && indexCount > 0, "Geometry arena allocations need vertices and indices");
+
+		size_t vertexOffset = AllocateRange(m_FreeVertices, vertexCount);
+		size_t indexOffset = AllocateRange(m_FreeIndices, indexCount);
+
+		if (vertexOffset == SIZE_MAX || indexOffset == SIZE_MAX)
+		{
+			if (vertexOffset != SIZE_MAX)
+				FreeRangeAt(m_FreeVertices, vertexOffset, vertexCount);
+			if (indexOffset != SIZE_MAX)
+				FreeRangeAt(m_FreeIndices, indexOffset, indexCount);
+
+			// Compacting leaves one free range at the end, grow as well when that is still too small
+			size_t usedVertices = m_VertexCapacity, usedIndices = m_IndexCapacity;
+			for (const FreeRange& range : m_FreeVertices)
+				usedVertices -= range.count;
+			for (const FreeRange& range : m_FreeIndices)
+				usedIndices -= range.count;
+
+			const size_t vertexCapacity = usedVertices + vertexCount <= m_VertexCapacity ? m_VertexCapacity : std::max(m_VertexCapacity * 2, usedVertices + vertexCount);
+			const size_t indexCapacity = usedIndices + indexCount <= m_IndexCapacity ? m_IndexCapacity : std::max(m_IndexCapacity * 2, usedIndices + indexCount);
+			Reallocate(vertexCapacity, indexCapacity);
+
+			vertexOffset = AllocateRange(m_FreeVertices, vertexCount);
+			indexOffset = AllocateRange(m_FreeIndices, indexCount);
+		}
+
+		const GLsizei stride = m_Layout.GetStride();
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_VBO);
+		glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(vertexOffset * stride), (GLsizeiptr)(vertexCount * stride), vertexData);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+
+		// The element binding belongs to the vertex array, copy through the generic binding instead
+		GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_IBO);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(indexOffset * sizeof(GLuint)), (GLsizeiptr)(indexCount * sizeof(GLuint)), indices);
+		GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		const Range range = { (GLint)vertexOffset, (GLuint)indexOffset, (GLuint)vertexCount, (GLuint)indexCount };
+
+		uint32_t allocation;
+		if (!m_FreeAllocations.empty())
+		{
+			allocation = m_FreeAllocations.back();
+			m_FreeAllocations.pop_back();
+			m_Allocations[allocation] = range;
+		}
+		else
+		{
+			allocation = (uint32_t)m_Allocations.size();
+			m_Allocations.push_back(range);
+		}
+		return allocation;
+	}
+
+	void GeometryArena::Free(const uint32_t allocation)
+	{
+		Range& range = m_Allocations[allocation];
+		CAMEL_ASSERT(range.baseVertex != FREED_BASE_VERTEX, "Geometry arena allocation {} is already freed", allocation);
+
+		FreeRangeAt(m_FreeVertices, (size_t)range.baseVertex, range.vertexCount);
+		FreeRangeAt(m_FreeIndices, range.firstIndex, range.indexCount);
+
+		range = { FREED_BASE_VERTEX, 0, 0, 0 };
+		m_FreeAllocations.push_back(allocation);
+	}
+
+	void GeometryArena::Compact()
+	{
+		// Already packed when the only free space is one range running to the end of the buffer
+		auto isPacked = [](const std::vector<FreeRange>& freeRanges, const size_t capacity)
+		{
+			return freeRanges.empty() || (freeRanges.size() == 1 && freeRanges[0].offset + freeRanges[0].count == capacity);
+		};
+
+		if (!isPacked(m_FreeVertices, m_VertexCapacity) || !isPacked(m_FreeIndices, m_IndexCapacity))
+			Reallocate(m_VertexCapacity, m_IndexCapacity);
+	}
+
+	void GeometryArena::MultiDraw(std::span<const ArenaDrawCommand> commands, const InstanceBuffer* perDraw)
+	{
+		if (commands.empty())
+			return;
+
+		CAMEL_ASSERT(!perDraw || perDraw->GetCount() >= commands.size(), "Per-draw buffer holds {} instances for {} draws", perDraw ? perDraw->GetCount() : 0, commands.size());
+
+		m_Commands.clear();
+		for (size_t i = 0; i < commands.size(); i++)
+		{
+			const ArenaDrawCommand& command = commands[i];
+			const Range& range = m_Allocations[command.allocation];
+			CAMEL_ASSERT(command.indexOffset + command.indexCount <= range.indexCount, "Draw of {} indices at {} exceeds allocation {}", command.indexCount, command.indexOffset, command.allocation);
+
+			m_Commands.push_back({ (GLuint)command.indexCount, 1, range.firstIndex + command.indexOffset, range.baseVertex, perDraw ? (GLuint)i : 0 });
+		}
+
+		Bind();
+
+		if (m_HasIndirectDraw)
+		{
+			if (perDraw)
+				perDraw->Apply();
+
+			GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+			glBufferData(GL_DRAW_INDIRECT_BUFFER, m_Commands.size() * sizeof(DrawElementsIndirectCommand), m_Commands.data(), GL_STREAM_DRAW);
+			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)m_Commands.size(), 0);
+		}
+		else
+		{
+			// Without base instances the per-draw attributes are re-pointed at each command's element
+			for (const DrawElementsIndirectCommand& command : m_Commands)
+			{
+				if (perDraw)
+					perDraw->Apply(command.baseInstance);
+
+				glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT, (const void*)(command.firstIndex * sizeof(GLuint)), 1, command.baseVertex);
+			}
+		}
+	}
+
+	size_t GeometryArena::AllocateRange(std::vector<FreeRange>& freeRanges, const size_t count)
+	{
+		// First fit, the buffers are compacted whenever fragmentation gets in the way
+		for (size_t i = 0; i < freeRanges.size(); i++)
+		{
+			FreeRange& range = freeRanges[i];
+			if (range.count < count)
+				continue;
+
+			const size_t offset = range.offset;
+			range.offset += count;
+			range.count -= count;
+			if (range.count == 0)
+				freeRanges.erase(freeRanges.begin() + i);
+			return offset;
+		}
+		return SIZE_MAX;
+	}
+
+	void GeometryArena::FreeRangeAt(std::vector<FreeRange>& freeRanges, const size_t offset, const size_t count)
+	{
+		auto next = std::lower_bound(freeRanges.begin(), freeRanges.end(), offset, [](const FreeRange& range, const size_t value) { return range.offset < value; });
+		next = freeRanges.insert(next, { offset, count });
+
+		// Merge with the following and preceding ranges when they touch
+		if (next + 1 != freeRanges.end() && next->offset + next->count == (next + 1)->offset)
+		{
+			next->count += (next + 1)->count;
+			freeRanges.erase(next + 1);
+		}
+		if (next != freeRanges.begin() && (next - 1)->offset + (next - 1)->count == next->offset)
+		{
+			(next - 1)->count += next->count;
+			freeRanges.erase(next);
+		}
+	}
+
+	void GeometryArena::Reallocate(const size_t vertexCapacity, const size_t indexCapacity)
+	{
+		const GLsizei stride = m_Layout.GetStride();
+
+		GLuint vertexBuffer, indexBuffer;
+		glGenBuffers(1, &vertexBuffer);
+		glGenBuffers(1, &indexBuffer);
+
+		GLState::BindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)(vertexCapacity * stride), nullptr, GL_STATIC_DRAW);
+		GLState::BindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)(indexCapacity * sizeof(GLuint)), nullptr, GL_STATIC_DRAW);
+
+		// Pack live allocations to the front, the GPU copies them without a round trip through memory
+		size_t vertexEnd = 0, indexEnd = 0;
+		for (Range& range : m_Allocations)
+		{
+			if (range.baseVertex == FREED_BASE_VERTEX)
+				continue;
+
+			GLState::BindBuffer(GL_COPY_READ_BUFFER, m_VBO);
+			GLState::BindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)range.baseVertex * stride, (GLintptr)(vertexEnd * stride), (GLsizeiptr)range.vertexCount * stride);
+
+			GLState::BindBuffer(GL_COPY_READ_BUFFER, m_IBO);
+			GLState::BindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)(range.firstIndex * sizeof(GLuint)), (GLintptr)(indexEnd * sizeof(GLuint)), (GLsizeiptr)(range.indexCount * sizeof(GLuint)));
+
+			range.baseVertex = (GLint)vertexEnd;
+			range.firstIndex = (GLuint)indexEnd;
+			vertexEnd += range.vertexCount;
+			indexEnd += range.indexCount;
+		}
+
+		GLState::BindBuffer(GL_COPY_READ_BUFFER, 0);
+		GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		GLState::DeleteBuffer(m_VBO);
+		GLState::DeleteBuffer(m_IBO);
+		m_VBO = vertexBuffer;
+		m_IBO = indexBuffer;
+		m_VertexCapacity = vertexCapacity;
+		m_IndexCapacity = indexCapacity;
+
+		m_FreeVertices.clear();
+		m_FreeIndices.clear();
+		if (vertexEnd < vertexCapacity)
+			m_FreeVertices.push_back({ vertexEnd, vertexCapacity - vertexEnd });
+		if (indexEnd < indexCapacity)
+			m_FreeIndices.push_back({ indexEnd, indexCapacity - indexEnd });
+
+		// Point the vertex array at the new buffers
+		GLState::BindVertexArray(m_VAO);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_VBO);
+		m_Layout.Apply();
+		GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IBO);
+		GLState::BindVertexArray(0);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Core.h"
+#include "GLState.h"
+#include "InstanceBuffer.h"
+#include "VertexLayout.h"
+
+#include <span>
+#include <vector>
+
+namespace Camel
+{
+	// One draw of an arena allocation, indexOffset is relative to the start of the allocation's indices
+	struct ArenaDrawCommand
+	{
+		uint32_t allocation;
+		GLuint indexOffset;
+		GLsizei indexCount;
+	};
+
+	// Large shared vertex and index buffers for every mesh of one vertex layout, with a single vertex array.
+	// Meshes get ranges of the buffers, so drawing many of them needs no vertex array changes and can go out
+	// as one multi-draw. Allocations are addressed by stable ids since compaction moves their ranges.
+	class GeometryArena final
+	{
+	public:
+		static constexpr uint32_t INVALID_ALLOCATION = UINT32_MAX;
+
+		// Location of an allocation in the shared buffers, in vertices and indices
+		struct Range
+		{
+			GLint baseVertex;
+			GLuint firstIndex;
+			GLuint vertexCount;
+			GLuint indexCount;
+		};
+
+	public:
+		GeometryArena(const VertexLayout& layout, const size_t vertexCapacity, const size_t indexCapacity);
+
+		// Meshes keep a pointer to their arena
+		GeometryArena(const GeometryArena&) = delete;
+		GeometryArena& operator=(const GeometryArena&) = delete;
+		GeometryArena(GeometryArena&&) = delete;
+		GeometryArena& operator=(GeometryArena&&) = delete;
+
+		~GeometryArena() noexcept;
+
+		// vertexData is in the arena's layout. Compacts or grows the buffers when no free range is large enough
+		uint32_t Allocate(const void* vertexData, const size_t vertexCount, const GLuint* indices, const size_t indexCount);
+		void Free(const uint32_t allocation);
+
+		// Moves every allocation to the front of the buffers, closing the holes left by Free
+		void Compact();
+
+		inline const Range& GetRange(const uint32_t allocation) const noexcept { return m_Allocations[allocation]; }
+
+		inline GLuint GetVertexArray() const noexcept { return m_VAO; }
+		inline void Bind() const noexcept { GLState::BindVertexArray(m_VAO); }
+		inline void Unbind() const noexcept { GLState::BindVertexArray(0); }
+
+		// Draws every command, in one glMultiDrawElementsIndirect call when ARB_multi_draw_indirect and ARB_base_instance
+		// are available and one glDrawElementsInstancedBaseVertex per command otherwise. Command i reads instance i of
+		// perDraw, when given, so per-draw data reaches the shader through the instanced attributes
+		void MultiDraw(std::span<const ArenaDrawCommand> commands, const InstanceBuffer* perDraw = nullptr);
+
+		inline const VertexLayout& GetLayout() const noexcept { return m_Layout; }
+		inline size_t GetVertexCapacity() const noexcept { return m_VertexCapacity; }
+		inline size_t GetIndexCapacity() const noexcept { return m_IndexCapacity; }
+		inline size_t GetAllocationCount() const noexcept { return m_Allocations.size() - m_FreeAllocations.size(); }
+		inline bool HasIndirectDraw() const noexcept { return m_HasIndirectDraw; }
+
+	private:
+		// Free span of a buffer, kept sorted by offset with neighbours merged
+		struct FreeRange
+		{
+			size_t offset;
+			size_t count;
+		};
+
+		// Matches the layout glMultiDrawElementsIndirect reads
+		struct DrawElementsIndirectCommand
+		{
+			GLuint count;
+			GLuint instanceCount;
+			GLuint firstIndex;
+			GLint baseVertex;
+			GLuint baseInstance;
+		};
+
+		static size_t AllocateRange(std::vector<FreeRange>& freeRanges, const size_t count);
+		static void FreeRangeAt(std::vector<FreeRange>& freeRanges, const size_t offset, const size_t count);
+
+		// Copies every live allocation, packed, into new buffers of the given capacities
+		void Reallocate(const size_t vertexCapacity, const size_t indexCapacity);
+
+	private:
+		VertexLayout m_Layout;
+		GLuint m_VAO, m_VBO, m_IBO, m_IndirectBuffer;
+		size_t m_VertexCapacity, m_IndexCapacity;
+
+		std::vector<FreeRange> m_FreeVertices;
+		std::vector<FreeRange> m_FreeIndices;
+
+		// Indexed by allocation id, freed ids are reused
+		std::vector<Range> m_Allocations;
+		std::vector<uint32_t> m_FreeAllocations;
+
+		std::vector<DrawElementsIndirectCommand> m_Commands; // Reused every MultiDraw
+		bool m_HasIndirectDraw;
+	};
+}
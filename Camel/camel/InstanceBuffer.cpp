@@ -0,0 +1,82 @@
+#include "InstanceBuffer.h"
+
+#include <algorithm>
+
+namespace Camel
+{
+	InstanceBuffer::InstanceBuffer(const size_t capacity)
+		: m_VBO(0), m_Count(0), m_Capacity(capacity)
+	{
+		glGenBuffers(1, &m_VBO);
+
+		if (capacity > 0)
+		{
+			GLState::BindBuffer(GL_ARRAY_BUFFER, m_VBO);
+			glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+			GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+	}
+
+	InstanceBuffer::InstanceBuffer(InstanceBuffer&& other) noexcept
+		: m_VBO(other.m_VBO), m_Count(other.m_Count), m_Capacity(other.m_Capacity)
+	{
+		other.m_VBO = 0;
+		other.m_Count = 0;
+		other.m_Capacity = 0;
+	}
+
+	InstanceBuffer& InstanceBuffer::operator=(InstanceBuffer&& other) noexcept
+	{
+		if (this != &other)
+		{
+			GLState::DeleteBuffer(m_VBO);
+
+			m_VBO = other.m_VBO;
+			m_Count = other.m_Count;
+			m_Capacity = other.m_Capacity;
+
+			other.m_VBO = 0;
+			other.m_Count = 0;
+			other.m_Capacity = 0;
+		}
+		return *this;
+	}
+
+	InstanceBuffer::~InstanceBuffer() noexcept
+	{
+		GLState::DeleteBuffer(m_VBO);
+	}
+
+	void InstanceBuffer::SetInstances(std::span<const InstanceData> instances)
+	{
+		// Grow geometrically so instance counts that creep up every frame do not reallocate every frame
+		if (instances.size() > m_Capacity)
+			m_Capacity = std::max(instances.size(), m_Capacity * 2);
+
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_VBO);
+		glBufferData(GL_ARRAY_BUFFER, m_Capacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+		if (!instances.empty())
+			glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size_bytes(), instances.data());
+
+		m_Count = instances.size();
+	}
+
+	void InstanceBuffer::Apply(const size_t firstInstance) const noexcept
+	{
+		const GLintptr baseOffset = (GLintptr)(firstInstance * sizeof(InstanceData));
+
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_VBO);
+
+		for (GLuint column = 0; column < 4; column++)
+		{
+			const GLuint location = INSTANCE_MODEL_ATTRIBUTE_LOCATION + column;
+			glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const void*)(baseOffset + offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+			glEnableVertexAttribArray(location);
+			glVertexAttribDivisor(location, 1);
+		}
+
+		glVertexAttribPointer(INSTANCE_COLOR_ATTRIBUTE_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const void*)(baseOffset + offsetof(InstanceData, color)));
+		glEnableVertexAttribArray(INSTANCE_COLOR_ATTRIBUTE_LOCATION);
+		glVertexAttribDivisor(INSTANCE_COLOR_ATTRIBUTE_LOCATION, 1);
+	}
+}
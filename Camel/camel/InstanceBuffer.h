@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Core.h"
+#include "GLState.h"
+#include "VertexLayout.h"
+
+#include <span>
+
+namespace Camel
+{
+	// Per-instance attributes, read at INSTANCE_MODEL_ATTRIBUTE_LOCATION and INSTANCE_COLOR_ATTRIBUTE_LOCATION
+	struct InstanceData
+	{
+		glm::mat4 model = glm::mat4(1.0f);
+		glm::vec4 color = glm::vec4(1.0f);
+	};
+
+	// GPU array of InstanceData fed to Mesh::DrawInstanced, advancing once per instance instead of once per vertex
+	class InstanceBuffer final
+	{
+	public:
+		explicit InstanceBuffer(const size_t capacity = 0);
+
+		InstanceBuffer(const InstanceBuffer&) = delete;
+		InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+		InstanceBuffer(InstanceBuffer&& other) noexcept;
+		InstanceBuffer& operator=(InstanceBuffer&& other) noexcept;
+
+		~InstanceBuffer() noexcept;
+
+		// Replaces the contents. The storage is orphaned first, so draws still reading the previous contents do not stall
+		void SetInstances(std::span<const InstanceData> instances);
+
+		// Points the instanced attributes of the bound vertex array at this buffer, starting firstInstance in
+		void Apply(const size_t firstInstance = 0) const noexcept;
+
+		inline size_t GetCount() const noexcept { return m_Count; }
+		inline size_t GetCapacity() const noexcept { return m_Capacity; }
+
+	private:
+		GLuint m_VBO;
+		size_t m_Count;
+		size_t m_Capacity;
+	};
+}
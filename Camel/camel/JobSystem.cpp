@@ -0,0 +1,207 @@
+#include "JobSystem.h"
+
+namespace Camel
+{
+	namespace
+	{
+		// Set on worker threads so submissions from inside a job go to that worker's own deque
+		thread_local const JobSystem* t_System = nullptr;
+		thread_local size_t t_QueueIndex = 0;
+
+		// Set while a background job runs on this thread
+		thread_local bool t_IsInBackground = false;
+	}
+
+	JobSystem::JobSystem(unsigned int workerCount)
+		: m_QueuedCount(0), m_IsStopping(false)
+	{
+		// The calling thread helps while it waits, so it counts as the remaining core
+		if (workerCount == 0)
+		{
+			const unsigned int cores = std::thread::hardware_concurrency();
+			workerCount = cores > 1 ? cores - 1 : 1;
+		}
+
+		for (unsigned int i = 0; i <= workerCount; i++)
+			m_Queues.push_back(std::make_unique<Queue>());
+
+		for (unsigned int i = 0; i < workerCount; i++)
+			m_Workers.emplace_back(&JobSystem::WorkerLoop, this, (size_t)i + 1);
+	}
+
+	JobSystem::~JobSystem() noexcept
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+			m_IsStopping = true;
+		}
+		m_SleepCondition.notify_all();
+
+		// Jobs still queued are dropped
+		for (std::thread& worker : m_Workers)
+			worker.join();
+	}
+
+	void JobSystem::Run(Job job, JobCounter* counter, const JobPriority priority)
+	{
+		if (counter)
+			counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+
+		Push({ std::move(job), counter, priority });
+	}
+
+	void JobSystem::RunAfter(JobCounter& dependency, Job job, JobCounter* counter, const JobPriority priority)
+	{
+		if (counter)
+			counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+
+		{
+			// Finish decrements under the same lock, so the job is either seen here as ready or picked up there
+			std::lock_guard<std::mutex> lock(dependency.m_ContinuationMutex);
+			if (!dependency.IsDone())
+			{
+				dependency.m_Continuations.push_back({ std::move(job), counter, priority });
+				return;
+			}
+		}
+
+		Push({ std::move(job), counter, priority });
+	}
+
+	void JobSystem::Wait(const JobCounter& counter)
+	{
+		const size_t queueIndex = GetQueueIndex();
+		while (!counter.IsDone())
+		{
+			if (!TryRunJob(queueIndex, t_IsInBackground))
+				std::this_thread::yield();
+		}
+
+		// The last Finish may still be releasing the lock
+		std::lock_guard<std::mutex> lock(counter.m_ContinuationMutex);
+	}
+
+	size_t JobSystem::GetQueueIndex() const noexcept
+	{
+		return t_System == this ? t_QueueIndex : 0;
+	}
+
+	void JobSystem::Push(QueuedJob job)
+	{
+		// Work split off a background job must not leak into frame waits either
+		if (t_IsInBackground && t_System == this)
+			job.priority = JobPriority::BACKGROUND;
+
+		Queue& queue = job.priority == JobPriority::BACKGROUND ? m_BackgroundQueue : *m_Queues[GetQueueIndex()];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.jobs.push_back(std::move(job));
+		}
+
+		m_QueuedCount.fetch_add(1, std::memory_order_release);
+		{
+			// Pairs with the predicate check in WorkerLoop so the wake up cannot be missed
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+		}
+		m_SleepCondition.notify_one();
+	}
+
+	bool JobSystem::TryRunJob(const size_t queueIndex, const bool canRunBackground)
+	{
+		QueuedJob job;
+		bool isFound = false;
+
+		// Newest own job first, it is the most likely to still be in cache
+		{
+			Queue& queue = *m_Queues[queueIndex];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.jobs.empty())
+			{
+				job = std::move(queue.jobs.back());
+				queue.jobs.pop_back();
+				isFound = true;
+			}
+		}
+
+		// Otherwise steal the oldest job of another queue, those tend to be the largest
+		for (size_t offset = 1; !isFound && offset < m_Queues.size(); offset++)
+		{
+			Queue& queue = *m_Queues[(queueIndex + offset) % m_Queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.jobs.empty())
+			{
+				job = std::move(queue.jobs.front());
+				queue.jobs.pop_front();
+				isFound = true;
+			}
+		}
+
+		// Background work last. A background job waiting on its own batches takes the newest, idle workers the oldest
+		if (!isFound && canRunBackground)
+		{
+			std::lock_guard<std::mutex> lock(m_BackgroundQueue.mutex);
+			if (!m_BackgroundQueue.jobs.empty())
+			{
+				if (t_IsInBackground)
+				{
+					job = std::move(m_BackgroundQueue.jobs.back());
+					m_BackgroundQueue.jobs.pop_back();
+				}
+				else
+				{
+					job = std::move(m_BackgroundQueue.jobs.front());
+					m_BackgroundQueue.jobs.pop_front();
+				}
+				isFound = true;
+			}
+		}
+
+		if (!isFound)
+			return false;
+
+		m_QueuedCount.fetch_sub(1, std::memory_order_relaxed);
+
+		const bool wasInBackground = t_IsInBackground;
+		t_IsInBackground = job.priority == JobPriority::BACKGROUND;
+		job.job();
+		t_IsInBackground = wasInBackground;
+
+		Finish(job.counter);
+		return true;
+	}
+
+	void JobSystem::Finish(JobCounter* counter)
+	{
+		if (!counter)
+			return;
+
+		// Decremented under the lock so Wait cannot return, and the counter go away, while it is still held here
+		std::vector<QueuedJob> continuations;
+		{
+			std::lock_guard<std::mutex> lock(counter->m_ContinuationMutex);
+			if (counter->m_Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				continuations.swap(counter->m_Continuations);
+		}
+
+		for (QueuedJob& continuation : continuations)
+			Push(std::move(continuation));
+	}
+
+	void JobSystem::WorkerLoop(const size_t queueIndex)
+	{
+		t_System = this;
+		t_QueueIndex = queueIndex;
+
+		while (true)
+		{
+			if (TryRunJob(queueIndex, true))
+				continue;
+
+			std::unique_lock<std::mutex> lock(m_SleepMutex);
+			m_SleepCondition.wait(lock, [this]() { return m_IsStopping || m_QueuedCount.load(std::memory_order_acquire) > 0; });
+
+			if (m_IsStopping)
+				return;
+		}
+	}
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Core.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Camel
+{
+	class JobCounter;
+
+	enum class JobPriority
+	{
+		// Frame work, every thread helps with it while waiting
+		NORMAL,
+		// Long running work such as asset decodes. Only workers run it, so waiting on frame work never picks it up
+		BACKGROUND,
+	};
+
+	struct QueuedJob
+	{
+		std::function<void()> job;
+		JobCounter* counter = nullptr;
+		JobPriority priority = JobPriority::NORMAL;
+	};
+
+	// Counts jobs that have not finished yet. Jobs submitted with RunAfter start once it reaches zero.
+	// Destroy it only after JobSystem::Wait on it returned
+	class JobCounter final
+	{
+	public:
+		JobCounter() = default;
+
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		inline bool IsDone() const noexcept { return m_Pending.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+
+		std::atomic<uint32_t> m_Pending = 0;
+
+		mutable std::mutex m_ContinuationMutex;
+		std::vector<QueuedJob> m_Continuations;
+	};
+
+	// Runs jobs on one worker per remaining core. Every thread has its own deque, owners pop their newest job and idle
+	// workers steal the oldest job of another deque. Threads that are not workers, such as the main thread, share one deque.
+	// Background jobs share a separate deque that only workers take from, and jobs submitted from a background job are
+	// background as well. Jobs must not throw, and waiting threads run queued jobs of their own priority instead of blocking
+	class JobSystem final
+	{
+	public:
+		using Job = std::function<void()>;
+
+	public:
+		explicit JobSystem(unsigned int workerCount = 0);
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		~JobSystem() noexcept;
+
+		// counter, when given, is incremented now and decremented once the job finished
+		void Run(Job job, JobCounter* counter = nullptr, const JobPriority priority = JobPriority::NORMAL);
+
+		// Queues the job once dependency reaches zero, right away if it already has
+		void RunAfter(JobCounter& dependency, Job job, JobCounter* counter = nullptr, const JobPriority priority = JobPriority::NORMAL);
+
+		// Runs queued jobs on the calling thread until counter reaches zero. Background jobs are only run when the
+		// calling thread is itself inside one, so the main thread never ends up decoding an asset mid frame
+		void Wait(const JobCounter& counter);
+
+		// Calls function(begin, end) over [0, count) in batches of batchSize and returns once all of them finished.
+		// The calling thread takes the first batch, so small ranges never leave it
+		template<typename Function>
+		void ParallelFor(const size_t count, const size_t batchSize, Function&& function)
+		{
+			CAMEL_ASSERT(batchSize > 0, "Parallel for batch size must be positive");
+
+			if (count == 0)
+				return;
+
+			if (m_Workers.empty() || count <= batchSize)
+			{
+				function((size_t)0, count);
+				return;
+			}
+
+			JobCounter counter;
+			for (size_t begin = batchSize; begin < count; begin += batchSize)
+			{
+				const size_t end = std::min(begin + batchSize, count);
+				Run([&function, begin, end]() { function(begin, end); }, &counter);
+			}
+
+			function((size_t)0, batchSize);
+			Wait(counter);
+		}
+
+		// Worker threads only, the calling thread adds one more
+		inline size_t GetWorkerCount() const noexcept { return m_Workers.size(); }
+
+	private:
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<QueuedJob> jobs;
+		};
+
+		// Queue of the calling thread, 0 is shared by every thread that is not a worker of this system
+		size_t GetQueueIndex() const noexcept;
+
+		void Push(QueuedJob job);
+		bool TryRunJob(const size_t queueIndex, const bool canRunBackground);
+		void Finish(JobCounter* counter);
+		void WorkerLoop(const size_t queueIndex);
+
+	private:
+		std::vector<std::unique_ptr<Queue>> m_Queues;
+		Queue m_BackgroundQueue;
+		std::vector<std::thread> m_Workers;
+
+		std::atomic<size_t> m_QueuedCount;
+
+		std::mutex m_SleepMutex;
+		std::condition_variable m_SleepCondition;
+		bool m_IsStopping;
+	};
+}
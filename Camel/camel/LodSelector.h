@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Core.h"
+#include "Camera.h"
+#include "Mesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+
+namespace Camel
+{
+	// Picks the coarsest level of detail whose simplification error stays under a pixel threshold on screen
+	class LodSelector final
+	{
+	public:
+		LodSelector(const float pixelThreshold = 1.0f)
+			: m_PixelThreshold(pixelThreshold), m_CameraPosition(0.0f), m_NearPlane(0.1f), m_PixelsPerUnit(0.0f)
+		{
+			CAMEL_ASSERT(pixelThreshold > 0, "LOD pixel threshold {} must be positive.", pixelThreshold);
+		}
+
+		~LodSelector() = default;
+
+		// Call once per frame before selecting, viewportHeight is in pixels
+		inline void SetView(const Camera& camera, const float viewportHeight) noexcept
+		{
+			m_CameraPosition = camera.GetTransform().GetWorldPosition();
+			m_NearPlane = camera.GetNearPlane();
+
+			// Pixels covered by one world unit at distance one
+			m_PixelsPerUnit = viewportHeight / (2.0f * std::tan(glm::radians(camera.GetFOV()) * 0.5f));
+		}
+
+		inline size_t Select(const Mesh& mesh, const glm::mat4& model) const noexcept
+		{
+			const std::vector<MeshLod>& lods = mesh.GetLods();
+			const Bounds& bounds = mesh.GetBounds();
+
+			// Errors and bounds are in model space, scale them by the largest axis of the model matrix
+			const float scale = std::sqrt(std::max(std::max(glm::dot(glm::vec3(model[0]), glm::vec3(model[0])), glm::dot(glm::vec3(model[1]), glm::vec3(model[1]))), glm::dot(glm::vec3(model[2]), glm::vec3(model[2]))));
+			const glm::vec3 center = glm::vec3(model * glm::vec4(bounds.center, 1.0f));
+
+			// Distance to the nearest point of the bounding sphere, the error can be anywhere on the mesh
+			const float distance = std::max(glm::length(center - m_CameraPosition) - bounds.radius * scale, m_NearPlane);
+
+			for (size_t lod = lods.size() - 1; lod > 0; lod--)
+			{
+				if (lods[lod].error * scale * m_PixelsPerUnit / distance <= m_PixelThreshold)
+					return lod;
+			}
+			return 0;
+		}
+
+		inline float GetPixelThreshold() const noexcept { return m_PixelThreshold; }
+		inline void SetPixelThreshold(const float pixelThreshold) noexcept { m_PixelThreshold = pixelThreshold; }
+
+	private:
+		float m_PixelThreshold;
+		glm::vec3 m_CameraPosition;
+		float m_NearPlane;
+		float m_PixelsPerUnit;
+	};
+}
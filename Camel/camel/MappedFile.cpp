@@ -0,0 +1,161 @@
+#include "MappedFile.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Camel
+{
+	namespace
+	{
+		// Smallest page size of the supported platforms, reading one byte this far apart faults every page in
+		constexpr size_t PAGE_TOUCH_STRIDE = 4096;
+	}
+
+	MappedFile::MappedFile(const std::string& filePath)
+		: m_Data(nullptr), m_Size(0)
+	{
+#ifdef _WIN32
+		HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			CAMEL_LOG_ERROR("Failed to open file for mapping at path: {}", filePath);
+			throw std::runtime_error("Failed to open file for mapping at path: " + filePath);
+		}
+
+		LARGE_INTEGER size{};
+		if (!GetFileSizeEx(file, &size))
+		{
+			CloseHandle(file);
+			CAMEL_LOG_ERROR("Failed to query size of file at path: {}", filePath);
+			throw std::runtime_error("Failed to query size of file at path: " + filePath);
+		}
+
+		m_Size = (size_t)size.QuadPart;
+
+		// Empty files cannot be mapped, they are simply exposed as an empty view
+		if (m_Size > 0)
+		{
+			HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping)
+			{
+				m_Data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping); // The view keeps the mapping alive
+			}
+		}
+
+		CloseHandle(file);
+#else
+		int file = open(filePath.c_str(), O_RDONLY);
+		if (file == -1)
+		{
+			CAMEL_LOG_ERROR("Failed to open file for mapping at path: {}", filePath);
+			throw std::runtime_error("Failed to open file for mapping at path: " + filePath);
+		}
+
+		struct stat info {};
+		if (fstat(file, &info) != 0)
+		{
+			close(file);
+			CAMEL_LOG_ERROR("Failed to query size of file at path: {}", filePath);
+			throw std::runtime_error("Failed to query size of file at path: " + filePath);
+		}
+
+		m_Size = (size_t)info.st_size;
+
+		// Empty files cannot be mapped, they are simply exposed as an empty view
+		if (m_Size > 0)
+		{
+			void* view = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+			if (view != MAP_FAILED)
+			{
+				madvise(view, m_Size, MADV_SEQUENTIAL);
+				m_Data = (const char*)view;
+			}
+		}
+
+		close(file); // The mapping stays valid after the descriptor is closed
+#endif
+
+		if (m_Size > 0 && !m_Data)
+		{
+			CAMEL_LOG_ERROR("Failed to map file at path: {}", filePath);
+			throw std::runtime_error("Failed to map file at path: " + filePath);
+		}
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+		: m_Data(other.m_Data), m_Size(other.m_Size)
+	{
+		other.m_Data = nullptr;
+		other.m_Size = 0;
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Unmap();
+
+			m_Data = other.m_Data;
+			m_Size = other.m_Size;
+
+			other.m_Data = nullptr;
+			other.m_Size = 0;
+		}
+		return *this;
+	}
+
+	MappedFile::~MappedFile() noexcept
+	{
+		Unmap();
+	}
+
+	void MappedFile::Prefetch(const size_t offset, const size_t size) const noexcept
+	{
+		if (!m_Data || offset >= m_Size || size == 0)
+			return;
+
+		const size_t count = std::min(size, m_Size - offset);
+		const char* begin = m_Data + offset;
+
+		// Let the OS read the whole range ahead in large requests, then touch every page so it is resident before returning
+#ifdef _WIN32
+		WIN32_MEMORY_RANGE_ENTRY range = { (PVOID)begin, count };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+		const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+		const uintptr_t pageBegin = (uintptr_t)begin / pageSize * pageSize;
+		madvise((void*)pageBegin, (uintptr_t)begin + count - pageBegin, MADV_WILLNEED);
+#endif
+
+		volatile char sink = 0;
+		for (size_t i = 0; i < count; i += PAGE_TOUCH_STRIDE)
+			sink = sink + begin[i];
+		sink = sink + begin[count - 1];
+	}
+
+	void MappedFile::Unmap() noexcept
+	{
+		if (!m_Data)
+			return;
+
+#ifdef _WIN32
+		UnmapViewOfFile(m_Data);
+#else
+		munmap((void*)m_Data, m_Size);
+#endif
+
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+}
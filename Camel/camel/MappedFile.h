@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Core.h"
+
+namespace Camel
+{
+	// Read-only view of a whole file mapped into memory
+	class MappedFile final
+	{
+	public:
+		MappedFile(const std::string& filePath);
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		~MappedFile() noexcept;
+
+		inline const char* GetData() const noexcept { return m_Data; }
+		inline size_t GetSize() const noexcept { return m_Size; }
+
+		// Reads a range in from disk now, so later accesses (such as a driver copying it) do not fault on the pages one by one
+		void Prefetch(const size_t offset, const size_t size) const noexcept;
+
+	private:
+		void Unmap() noexcept;
+
+	private:
+		const char* m_Data;
+		size_t m_Size;
+	};
+}
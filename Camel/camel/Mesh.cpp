@@ -1,127 +1,256 @@
 #include "Mesh.h"
+#include "Frustum.h"
+#include "FrustumCuller.h"
+#include "MeshClusterBuilder.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "ObjParser.h"
 
-#include <fstream>
-#include <sstream>
 #include <algorithm>
 #include <filesystem>
 
 namespace Camel
 {
-	Mesh Mesh::Load(const std::string& filePath)
+	namespace
+	{
+		// Appends coarser levels of detail after the full resolution indices
+		void GenerateLods(MeshData& data, const MeshImportSettings& settings)
+		{
+			const std::vector<GLuint> source = data.indices;
+			const float radius = Bounds::FromPoints(reinterpret_cast<const glm::vec3*>(data.vertices.data()), data.vertices.size(), sizeof(Vertex)).radius;
+
+			data.lods = { { 0, (GLsizei)source.size(), 0.0f } };
+
+			size_t targetIndexCount = source.size();
+			for (unsigned int level = 1; level < settings.lodCount; level++)
+			{
+				targetIndexCount = (size_t)(targetIndexCount * settings.lodReduction) / 3 * 3;
+
+				// Each level simplifies the full resolution mesh so its error is measured against the original surface
+				float error = 0.0f;
+				std::vector<GLuint> indices = MeshSimplifier::Simplify(data.vertices, source, targetIndexCount, settings.lodMaxError, &error);
+
+				// Stop once the error bound no longer allows a meaningful reduction
+				const MeshLod& previous = data.lods.back();
+				if (indices.empty() || indices.size() > (size_t)previous.indexCount * 9 / 10)
+					break;
+
+				if (settings.optimize)
+					MeshOptimizer::OptimizeVertexCache(indices, data.vertices.size());
+
+				data.lods.push_back({ (GLuint)data.indices.size(), (GLsizei)indices.size(), error * radius });
+				data.indices.insert(data.indices.end(), indices.begin(), indices.end());
+			}
+
+			for (size_t level = 1; level < data.lods.size(); level++)
+				CAMEL_LOG_INFO("Generated LOD {}: {} triangles, error {}", level, data.lods[level].indexCount / 3, data.lods[level].error);
+		}
+
+		MeshData Import(const std::string& filePath, const MeshImportSettings& settings, JobSystem* jobSystem = nullptr)
+		{
+			MeshData data = ObjParser::ParseFile(filePath, 0, nullptr, jobSystem);
+
+			if (settings.optimize)
+				MeshOptimizer::Optimize(data);
+
+			if (settings.buildClusters)
+				data.clusters = MeshClusterBuilder::Build(data.vertices, data.indices, data.indices.size());
+
+			if (settings.lodCount > 1)
+				GenerateLods(data, settings);
+
+			return data;
+		}
+	}
+
+	MeshSource::MeshSource() noexcept = default;
+	MeshSource::MeshSource(MeshSource&& other) noexcept = default;
+	MeshSource& MeshSource::operator=(MeshSource&& other) noexcept = default;
+	MeshSource::~MeshSource() noexcept = default;
+
+	Mesh Mesh::Load(const std::string& filePath, const MeshImportSettings& settings)
+	{
+		return Mesh(Read(filePath, settings));
+	}
+
+	MeshSource Mesh::Read(const std::string& filePath, const MeshImportSettings& settings, JobSystem* jobSystem)
 	{
 		std::string fileExtension = std::filesystem::path(filePath).extension().string();
 
+		MeshSource source;
+		source.vertexFormat = settings.vertexFormat;
+
+		if (fileExtension == MeshFile::EXTENSION)
+		{
+			source.file = std::make_unique<MeshFile>(filePath);
+			source.file->Prefetch();
+			return source;
+		}
+
 		if (fileExtension != ".obj")
 		{
 			CAMEL_LOG_ERROR("Failed to load mesh. Extension {} not supported", fileExtension);
 			throw std::runtime_error("Failed to load mesh. Extension " + fileExtension + " not supported");
 		}
 
-		std::ifstream file(filePath);
-		if (!file.is_open())
+		// Prefer the cooked version when it was built from the current source with the same settings
+		const std::string cookedPath = MeshFile::GetCookedPath(filePath);
+		if (MeshFile::IsUpToDate(cookedPath, filePath))
 		{
-			CAMEL_LOG_ERROR("Failed to load obj mesh at path: {}", filePath);
-			throw std::runtime_error("Failed to load obj mesh at path: " + filePath);
+			try
+			{
+				auto file = std::make_unique<MeshFile>(cookedPath);
+				if (file->WasCookedWith(settings))
+				{
+					file->Prefetch();
+					source.file = std::move(file);
+					return source;
+				}
+
+				CAMEL_LOG_WARN("Cooked mesh {} was cooked with different import settings, loading {} instead", cookedPath, filePath);
+			}
+			catch (const std::runtime_error&)
+			{
+				CAMEL_LOG_WARN("Ignoring unreadable cooked mesh {}, loading {} instead", cookedPath, filePath);
+			}
 		}
 
-		std::vector<glm::vec3> temp_positions, temp_normals;
-		std::vector<glm::vec2> temp_texCoords;
+		source.data = Import(filePath, settings, jobSystem);
+
+		// Bounds and packing are the last passes over every vertex, done here so they stay off the GL thread
+		source.bounds = Bounds::FromPoints(reinterpret_cast<const glm::vec3*>(source.data.vertices.data()), source.data.vertices.size(), sizeof(Vertex));
+		source.vertices = VertexLayout::Pack(source.data.vertices, settings.vertexFormat, source.bounds);
+		source.data.vertices = {};
+		return source;
+	}
 
-		std::vector<Vertex> vertices;
-		std::vector<unsigned int> indices;
+	void Mesh::Cook(const std::string& filePath, const MeshImportSettings& settings)
+	{
+		std::string fileExtension = std::filesystem::path(filePath).extension().string();
 
-		std::string line;
-		while (std::getline(file, line))
+		if (fileExtension != ".obj")
 		{
-			std::istringstream iss(line);
-			std::string prefix;
-			iss >> prefix;
+			CAMEL_LOG_ERROR("Failed to cook mesh. Extension {} not supported", fileExtension);
+			throw std::runtime_error("Failed to cook mesh. Extension " + fileExtension + " not supported");
+		}
 
-			if (prefix == "v")
-			{
-				glm::vec3 position{};
-				iss >> position.x >> position.y >> position.z;
-				temp_positions.push_back(position);
-			}
-			else if (prefix == "vn")
-			{
-				glm::vec3 normal{};
-				iss >> normal.x >> normal.y >> normal.z;
-				temp_normals.push_back(normal);
-			}
-			else if (prefix == "vt")
-			{
-				glm::vec2 texCoord{};
-				iss >> texCoord.x >> texCoord.y;
-				temp_texCoords.push_back(texCoord);
-			}
-			else if (prefix == "f")
-			{
-				std::string vertexInfo;
-				while (iss >> vertexInfo)
-				{
-					std::replace(vertexInfo.begin(), vertexInfo.end(), '/', ' ');
-					std::istringstream vertexStream(vertexInfo);
+		MeshFile::Write(MeshFile::GetCookedPath(filePath), filePath, Import(filePath, settings), settings);
+	}
 
-					unsigned int posIndex, texIndex, normIndex;
-					vertexStream >> posIndex >> texIndex >> normIndex;
+	Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, const VertexFormat format, const std::vector<MeshLod>& lods, const std::vector<MeshCluster>& clusters, GeometryArena* arena)
+		: m_VAO(0), m_VBO(0), m_IBO(0), m_Arena(arena), m_Allocation(GeometryArena::INVALID_ALLOCATION),
+		m_Lods(lods), m_Clusters(clusters), m_Bounds(Bounds::FromPoints(reinterpret_cast<const glm::vec3*>(vertices.data()), vertices.size(), sizeof(Vertex))), m_DequantizeMatrix(1.0f)
+	{
+		if (m_Lods.empty())
+			m_Lods.push_back({ 0, (GLsizei)indices.size(), 0.0f });
 
-					// obj indices are 1-based, so subtract 1 to make them 0-based
-					// TODO: You can optimize this by not creating new vertex for each entry as there will be duplicates.
-					Vertex vertex = { temp_positions[posIndex - 1], temp_normals[normIndex - 1], temp_texCoords[texIndex - 1] };
-					vertices.push_back(vertex);
+		PrepareClusters();
 
-					// Assuming a triangulated mesh, add indices in order
-					indices.push_back((GLuint)indices.size());
-				}
-			}
+		if (format == VertexFormat::STANDARD)
+		{
+			Create(VertexLayout::Get(format), vertices.data(), vertices.size() * sizeof(Vertex), indices.data(), indices.size());
 		}
+		else
+		{
+			PackedVertices packed = VertexLayout::Pack(vertices, format, m_Bounds);
+			m_DequantizeMatrix = packed.dequantize;
+			Create(VertexLayout::Get(format), packed.data.data(), packed.data.size(), indices.data(), indices.size());
+		}
+	}
+
+	Mesh::Mesh(const MeshFile& file, GeometryArena* arena)
+		: m_VAO(0), m_VBO(0), m_IBO(0), m_Arena(arena), m_Allocation(GeometryArena::INVALID_ALLOCATION),
+		m_Bounds(file.GetBounds()), m_DequantizeMatrix(file.GetDequantizeMatrix())
+	{
+		for (const MeshFileLod& lod : file.GetLods())
+			m_Lods.push_back({ lod.indexOffset, (GLsizei)lod.indexCount, lod.error });
+
+		for (const MeshFileCluster& cluster : file.GetClusters())
+			m_Clusters.push_back({ cluster.indexOffset, (GLsizei)cluster.indexCount, cluster.center, cluster.radius, cluster.coneAxis, cluster.coneCutoff });
+
+		PrepareClusters();
 
-		return Mesh(vertices, indices);
+		// The mapped blobs are already in GPU layout, copy them as is
+		Create(file.GetVertexLayout(), file.GetVertexData(), file.GetVertexDataSize(), file.GetIndexData(), file.GetHeader().indexCount);
 	}
 
-	Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices)
+	Mesh::Mesh(const MeshSource& source, GeometryArena* arena)
+		: Mesh(source.file ? Mesh(*source.file, arena) : Mesh(source.vertices, source.vertexFormat, source.bounds, source.data.indices, source.data.lods, source.data.clusters, arena))
+	{}
+
+	Mesh::Mesh(const PackedVertices& vertices, const VertexFormat format, const Bounds& bounds, const std::vector<GLuint>& indices, const std::vector<MeshLod>& lods, const std::vector<MeshCluster>& clusters, GeometryArena* arena)
+		: m_VAO(0), m_VBO(0), m_IBO(0), m_Arena(arena), m_Allocation(GeometryArena::INVALID_ALLOCATION),
+		m_Lods(lods), m_Clusters(clusters), m_Bounds(bounds), m_DequantizeMatrix(vertices.dequantize)
+	{
+		if (m_Lods.empty())
+			m_Lods.push_back({ 0, (GLsizei)indices.size(), 0.0f });
+
+		PrepareClusters();
+
+		Create(VertexLayout::Get(format), vertices.data.data(), vertices.data.size(), indices.data(), indices.size());
+	}
+
+	void Mesh::PrepareClusters()
+	{
+		m_ClusterSpheres.clear();
+		m_ClusterSpheres.reserve(m_Clusters.size());
+		for (const MeshCluster& cluster : m_Clusters)
+			m_ClusterSpheres.emplace_back(cluster.center, cluster.radius);
+
+		m_VisibleClusters.reserve(m_Clusters.size());
+		m_DrawCounts.resize(m_Clusters.size());
+		m_DrawOffsets.resize(m_Clusters.size());
+		m_DrawBaseVertices.resize(m_Clusters.size());
+	}
+
+	void Mesh::Create(const VertexLayout& layout, const void* vertexData, const size_t vertexDataSize, const GLuint* indices, const size_t indexCount)
 	{
+		if (m_Arena)
+		{
+			if (!(layout == m_Arena->GetLayout()))
+			{
+				CAMEL_LOG_ERROR("Mesh vertex layout (stride {}) does not match its geometry arena (stride {})", layout.GetStride(), m_Arena->GetLayout().GetStride());
+				throw std::runtime_error("Mesh vertex layout does not match its geometry arena");
+			}
+
+			m_Allocation = m_Arena->Allocate(vertexData, vertexDataSize / layout.GetStride(), indices, indexCount);
+			return;
+		}
+
 		glGenVertexArrays(1, &m_VAO);
 		glGenBuffers(1, &m_VBO);
 		glGenBuffers(1, &m_IBO);
 
-		glBindVertexArray(m_VAO);
+		GLState::BindVertexArray(m_VAO);
 
 		// Copy vertices data
-		glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_VBO);
+		glBufferData(GL_ARRAY_BUFFER, vertexDataSize, vertexData, GL_STATIC_DRAW);
 
-		// Position (3 floats at index 0, 1, 2)
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)(offsetof(Vertex, position)));
-		glEnableVertexAttribArray(0);
-
-		// Normal (3 floats at index 3, 4, 5)
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)(offsetof(Vertex, normal)));
-		glEnableVertexAttribArray(1);
-
-		// Texcoord (2 floats at index 6, 7)
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)(offsetof(Vertex, texcoord)));
-		glEnableVertexAttribArray(2);
+		layout.Apply();
 
 		// Copy indices data
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+		GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(GLuint), indices, GL_STATIC_DRAW);
 
 		// Unbind
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
-
-		m_IndexCount = (GLsizei)indices.size();
+		GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+		GLState::BindVertexArray(0);
 	}
 
 	Mesh::Mesh(Mesh&& other) noexcept
-		: m_VAO(other.m_VAO), m_VBO(other.m_VBO), m_IBO(other.m_IBO), m_IndexCount(other.m_IndexCount)
+		: m_VAO(other.m_VAO), m_VBO(other.m_VBO), m_IBO(other.m_IBO), m_Arena(other.m_Arena), m_Allocation(other.m_Allocation), m_Lods(std::move(other.m_Lods)), m_Clusters(std::move(other.m_Clusters)),
+		m_ClusterSpheres(std::move(other.m_ClusterSpheres)), m_VisibleClusters(std::move(other.m_VisibleClusters)), m_DrawCounts(std::move(other.m_DrawCounts)), m_DrawOffsets(std::move(other.m_DrawOffsets)), m_DrawBaseVertices(std::move(other.m_DrawBaseVertices)), m_Bounds(other.m_Bounds), m_DequantizeMatrix(other.m_DequantizeMatrix)
 	{
 		other.m_VAO = 0;
 		other.m_VBO = 0;
 		other.m_IBO = 0;
-		other.m_IndexCount = 0;
+		other.m_Arena = nullptr;
+		other.m_Allocation = GeometryArena::INVALID_ALLOCATION;
+		other.m_Lods.clear();
+		other.m_Clusters.clear();
+		other.m_ClusterSpheres.clear();
 	}
 
 	Mesh& Mesh::operator=(Mesh&& other) noexcept
@@ -129,51 +258,166 @@ namespace Camel
 		if (this != &other)
 		{
 			// Release any resources we're holding
-			glDeleteVertexArrays(1, &m_VAO);
-			glDeleteBuffers(1, &m_VBO);
-			glDeleteBuffers(1, &m_IBO);
+			Release();
 
 			// Transfer ownership of other's resources to this
 			m_VAO = other.m_VAO;
 			m_VBO = other.m_VBO;
 			m_IBO = other.m_IBO;
-			m_IndexCount = other.m_IndexCount;
+			m_Arena = other.m_Arena;
+			m_Allocation = other.m_Allocation;
+			m_Lods = std::move(other.m_Lods);
+			m_Clusters = std::move(other.m_Clusters);
+			m_ClusterSpheres = std::move(other.m_ClusterSpheres);
+			m_VisibleClusters = std::move(other.m_VisibleClusters);
+			m_DrawCounts = std::move(other.m_DrawCounts);
+			m_DrawOffsets = std::move(other.m_DrawOffsets);
+			m_DrawBaseVertices = std::move(other.m_DrawBaseVertices);
+			m_Bounds = other.m_Bounds;
+			m_DequantizeMatrix = other.m_DequantizeMatrix;
 
 			// Leave other in a safely destructible state
 			other.m_VAO = 0;
 			other.m_VBO = 0;
 			other.m_IBO = 0;
-			other.m_IndexCount = 0;
+			other.m_Arena = nullptr;
+			other.m_Allocation = GeometryArena::INVALID_ALLOCATION;
+			other.m_Lods.clear();
+			other.m_Clusters.clear();
+			other.m_ClusterSpheres.clear();
 		}
 		return *this;
 	}
 
 	Mesh::~Mesh() noexcept
 	{
-		// Unbind
-		glBindVertexArray(0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		// Deleting the objects unbinds them, GLState keeps track
+		Release();
+	}
 
-		glDeleteVertexArrays(1, &m_VAO);
-		glDeleteBuffers(1, &m_VBO);
-		glDeleteBuffers(1, &m_IBO);
+	void Mesh::Release() noexcept
+	{
+		if (m_Arena)
+		{
+			if (m_Allocation != GeometryArena::INVALID_ALLOCATION)
+				m_Arena->Free(m_Allocation);
+			return;
+		}
+
+		GLState::DeleteVertexArray(m_VAO);
+		GLState::DeleteBuffer(m_VBO);
+		GLState::DeleteBuffer(m_IBO);
+	}
+
+	void Mesh::Draw(const size_t lod) const noexcept
+	{
+		Bind();
+		DrawBound(lod);
+	}
+
+	void Mesh::DrawClusters(const glm::mat4& model, const glm::mat4& viewProjection, const glm::vec3& cameraPosition) const noexcept
+	{
+		Bind();
+		DrawClustersBound(model, viewProjection, cameraPosition);
 	}
 
-	void Mesh::Draw() const noexcept
+	void Mesh::DrawInstanced(const InstanceBuffer& instances, const size_t lod, const size_t firstInstance, size_t instanceCount) const noexcept
 	{
-		glBindVertexArray(m_VAO);
-		glDrawElements(GL_TRIANGLES, m_IndexCount, GL_UNSIGNED_INT, nullptr);
-		glBindVertexArray(0);
+		CAMEL_ASSERT(lod < m_Lods.size(), "LOD {} out of range, mesh has {} levels", lod, m_Lods.size());
+		CAMEL_ASSERT(firstInstance <= instances.GetCount(), "First instance {} out of range, buffer has {} instances", firstInstance, instances.GetCount());
+
+		instanceCount = std::min(instanceCount, instances.GetCount() - firstInstance);
+		if (instanceCount == 0)
+			return;
+
+		Bind();
+		instances.Apply(firstInstance);
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m_Lods[lod].indexCount, GL_UNSIGNED_INT, (const void*)((GetFirstIndex() + m_Lods[lod].indexOffset) * sizeof(GLuint)), (GLsizei)instanceCount, GetBaseVertex());
+	}
+
+	GLsizei Mesh::DrawBound(const size_t lod) const noexcept
+	{
+		CAMEL_ASSERT(lod < m_Lods.size(), "LOD {} out of range, mesh has {} levels", lod, m_Lods.size());
+
+		glDrawElementsBaseVertex(GL_TRIANGLES, m_Lods[lod].indexCount, GL_UNSIGNED_INT, (const void*)((GetFirstIndex() + m_Lods[lod].indexOffset) * sizeof(GLuint)), GetBaseVertex());
+		return m_Lods[lod].indexCount;
+	}
+
+	GLsizei Mesh::DrawClustersBound(const glm::mat4& model, const glm::mat4& viewProjection, const glm::vec3& cameraPosition) const noexcept
+	{
+		if (m_Clusters.empty())
+			return DrawBound();
+
+		GLsizei indexCount = 0;
+		const GLsizei drawCount = CullClusters(model, viewProjection, cameraPosition, GetFirstIndex(), indexCount);
+		if (drawCount > 0)
+		{
+			// Every range shares the base vertex of the mesh
+			std::fill_n(m_DrawBaseVertices.begin(), drawCount, GetBaseVertex());
+			glMultiDrawElementsBaseVertex(GL_TRIANGLES, m_DrawCounts.data(), GL_UNSIGNED_INT, m_DrawOffsets.data(), drawCount, m_DrawBaseVertices.data());
+		}
+		return indexCount;
+	}
+
+	GLsizei Mesh::AppendArenaCommands(std::vector<ArenaDrawCommand>& commands, const size_t lod, const glm::mat4& model, const glm::mat4& viewProjection, const glm::vec3& cameraPosition) const
+	{
+		CAMEL_ASSERT(m_Arena, "Only meshes in a geometry arena have arena draw commands");
+		CAMEL_ASSERT(lod < m_Lods.size(), "LOD {} out of range, mesh has {} levels", lod, m_Lods.size());
+
+		if (lod != 0 || m_Clusters.empty())
+		{
+			commands.push_back({ m_Allocation, m_Lods[lod].indexOffset, m_Lods[lod].indexCount });
+			return m_Lods[lod].indexCount;
+		}
+
+		GLsizei indexCount = 0;
+		const GLsizei drawCount = CullClusters(model, viewProjection, cameraPosition, 0, indexCount);
+		for (GLsizei i = 0; i < drawCount; i++)
+			commands.push_back({ m_Allocation, (GLuint)((uintptr_t)m_DrawOffsets[i] / sizeof(GLuint)), m_DrawCounts[i] });
+		return indexCount;
+	}
+
+	GLsizei Mesh::CullClusters(const glm::mat4& model, const glm::mat4& viewProjection, const glm::vec3& cameraPosition, const GLuint firstIndex, GLsizei& indexCount) const noexcept
+	{
+		// Cull in model space, the planes of the full transform and the eye moved into the model are exact even under non-uniform scale
+		const Frustum frustum = Frustum::FromMatrix(viewProjection * model);
+		const glm::vec3 eye = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.0f));
+
+		GLsizei drawCount = 0;
+		GLuint rangeEnd = 0;
+		FrustumCuller::CullSpheres(frustum, m_ClusterSpheres.data(), m_ClusterSpheres.size(), m_VisibleClusters);
+		for (const uint32_t clusterIndex : m_VisibleClusters)
+		{
+			const MeshCluster& cluster = m_Clusters[clusterIndex];
+			const glm::vec3 toCluster = cluster.center - eye;
+			const float distance = glm::length(toCluster);
+			if (distance > cluster.radius && glm::dot(toCluster, cluster.coneAxis) >= cluster.coneCutoff * distance + cluster.radius)
+				continue;
+
+			// Clusters are stored back to back, merge neighbours into one range
+			if (drawCount > 0 && rangeEnd == cluster.indexOffset)
+			{
+				m_DrawCounts[drawCount - 1] += cluster.indexCount;
+			}
+			else
+			{
+				m_DrawCounts[drawCount] = cluster.indexCount;
+				m_DrawOffsets[drawCount] = (const void*)((firstIndex + cluster.indexOffset) * sizeof(GLuint));
+				drawCount++;
+			}
+			rangeEnd = cluster.indexOffset + cluster.indexCount;
+			indexCount += cluster.indexCount;
+		}
+		return drawCount;
 	}
 
-	void Mesh::DrawOutline(GLfloat lineWidth) const noexcept
+	void Mesh::DrawOutline(GLfloat lineWidth, const size_t lod) const noexcept
 	{
 		CAMEL_ASSERT(lineWidth > 0, "Outline width {} must be positive", lineWidth);
 
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		GLState::SetPolygonMode(GL_LINE);
 		glLineWidth(lineWidth);
-		Draw();
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		Draw(lod);
+		GLState::SetPolygonMode(GL_FILL);
 	}
 }
@@ -1,24 +1,93 @@
 #pragma once
 
 #include "Core.h"
+#include "Bounds.h"
+#include "GeometryArena.h"
+#include "GLState.h"
+#include "InstanceBuffer.h"
+#include "VertexLayout.h"
+
+#include <memory>
 #include <vector>
 
 namespace Camel
 {
-	struct Vertex
+	// One level of detail, a range of the shared index buffer
+	struct MeshLod
+	{
+		GLuint indexOffset;
+		GLsizei indexCount;
+		float error; // Maximum geometric deviation from the full resolution mesh, in model units
+	};
+
+	// Small group of triangles of the finest level of detail, culled as a whole
+	struct MeshCluster
+	{
+		GLuint indexOffset;
+		GLsizei indexCount;
+		glm::vec3 center;
+		float radius;
+		glm::vec3 coneAxis; // Backfacing when dot(normalize(center - eye), coneAxis) >= coneCutoff + radius / distance
+		float coneCutoff; // 1 disables cone culling
+	};
+
+	// CPU side indexed triangle list, as produced by the importers
+	struct MeshData
+	{
+		std::vector<Vertex> vertices;
+		std::vector<GLuint> indices;
+		std::vector<MeshLod> lods; // Finest first, all levels share the vertices. Empty means one level using every index
+		std::vector<MeshCluster> clusters; // Partition of the finest level, empty when clustering is off
+	};
+
+	// Processing applied to imported geometry before it is uploaded or cooked
+	struct MeshImportSettings
+	{
+		bool optimize = true; // Reorder triangles and vertices for the vertex cache, overdraw and vertex fetch
+		VertexFormat vertexFormat = VertexFormat::STANDARD;
+		unsigned int lodCount = 4; // Levels of detail to generate, including the full resolution one
+		float lodReduction = 0.5f; // Target triangle ratio between consecutive levels
+		float lodMaxError = 0.05f; // Simplification error bound, relative to the mesh bounding radius
+		bool buildClusters = false; // Partition the finest level into clusters for DrawClusters
+	};
+
+	class JobSystem;
+	class MeshFile;
+
+	// CPU side result of reading a mesh, either a cooked file used as is or freshly imported geometry.
+	// Both are in GPU layout already, so creating the Mesh only copies them into buffers
+	struct MeshSource
 	{
-		glm::vec3 position;
-		glm::vec3 normal;
-		glm::vec2 texcoord;
+		std::unique_ptr<MeshFile> file;
+		MeshData data; // Indices, LODs and clusters, the vertices are released once packed
+		PackedVertices vertices;
+		Bounds bounds;
+		VertexFormat vertexFormat = VertexFormat::STANDARD;
+
+		MeshSource() noexcept;
+		MeshSource(MeshSource&& other) noexcept;
+		MeshSource& operator=(MeshSource&& other) noexcept;
+		~MeshSource() noexcept;
 	};
 
 	class Mesh final
 	{
 	public:
-		static Mesh Load(const std::string& filePath);
+		// Loads a cooked .cmesh, or an .obj (preferring its cooked version when it is up to date)
+		static Mesh Load(const std::string& filePath, const MeshImportSettings& settings = {});
+
+		// The file reading and import half of Load, makes no GL calls so it can run on any thread.
+		// Parsing is split into jobs of jobSystem when given
+		static MeshSource Read(const std::string& filePath, const MeshImportSettings& settings = {}, JobSystem* jobSystem = nullptr);
+
+		// Offline step, writes the cooked .cmesh next to the .obj source
+		static void Cook(const std::string& filePath, const MeshImportSettings& settings = {});
 
 	public:
-		Mesh(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices);
+		// Meshes given an arena store their geometry in its shared buffers instead of their own, the arena must outlive them
+		Mesh(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, const VertexFormat format = VertexFormat::STANDARD, const std::vector<MeshLod>& lods = {}, const std::vector<MeshCluster>& clusters = {}, GeometryArena* arena = nullptr);
+		explicit Mesh(const MeshFile& file, GeometryArena* arena = nullptr);
+		explicit Mesh(const MeshSource& source, GeometryArena* arena = nullptr);
 
 		Mesh(const Mesh&) = delete;
 		Mesh& operator=(const Mesh&) = delete;
@@ -28,11 +97,69 @@ namespace Camel
 
 		~Mesh() noexcept;
 
-		void Draw() const noexcept;
-		void DrawOutline(GLfloat lineWidth = 3.0f) const noexcept;
+		inline void Bind() const noexcept { GLState::BindVertexArray(m_Arena ? m_Arena->GetVertexArray() : m_VAO); }
+		inline void Unbind() const noexcept { GLState::BindVertexArray(0); }
+
+		void Draw(const size_t lod = 0) const noexcept;
+		void DrawOutline(GLfloat lineWidth = 3.0f, const size_t lod = 0) const noexcept;
+
+		// Draws the clusters of the finest level that survive frustum and normal cone culling in one multi-draw.
+		// Meshes without clusters draw the finest level whole
+		void DrawClusters(const glm::mat4& model, const glm::mat4& viewProjection, const glm::vec3& cameraPosition) const noexcept;
+
+		// Draws instanceCount copies of a level in one call, each placed by its InstanceData starting at firstInstance.
+		// Positions are not dequantized by the instance matrix, shaders apply GetDequantizeMatrix through u_Dequantize
+		void DrawInstanced(const InstanceBuffer& instances, const size_t lod = 0, const size_t firstInstance = 0, size_t instanceCount = SIZE_MAX) const noexcept;
+
+		// Same as Draw and DrawClusters for a mesh that is already bound, so consecutive draws of it skip the rebind.
+		// Return the number of indices drawn
+		GLsizei DrawBound(const size_t lod = 0) const noexcept;
+		GLsizei DrawClustersBound(const glm::mat4& model, const glm::mat4& viewProjection, const glm::vec3& cameraPosition) const noexcept;
+
+		// Arena meshes only. Appends the draws DrawBound, or DrawClustersBound for the finest level, would make as commands
+		// for GeometryArena::MultiDraw. Returns the number of indices they draw
+		GLsizei AppendArenaCommands(std::vector<ArenaDrawCommand>& commands, const size_t lod, const glm::mat4& model, const glm::mat4& viewProjection, const glm::vec3& cameraPosition) const;
+
+		inline const Bounds& GetBounds() const noexcept { return m_Bounds; }
+		inline const std::vector<MeshLod>& GetLods() const noexcept { return m_Lods; }
+		inline const std::vector<MeshCluster>& GetClusters() const noexcept { return m_Clusters; }
+
+		// Maps quantized vertex positions back to model space, multiply it into the model matrix
+		inline const glm::mat4& GetDequantizeMatrix() const noexcept { return m_DequantizeMatrix; }
+
+		// Null for meshes owning their buffers. Lod and cluster index offsets are relative to the allocation
+		inline GeometryArena* GetArena() const noexcept { return m_Arena; }
+		inline uint32_t GetArenaAllocation() const noexcept { return m_Allocation; }
+
+	private:
+		Mesh(const PackedVertices& vertices, const VertexFormat format, const Bounds& bounds, const std::vector<GLuint>& indices, const std::vector<MeshLod>& lods, const std::vector<MeshCluster>& clusters, GeometryArena* arena);
+
+		void Create(const VertexLayout& layout, const void* vertexData, const size_t vertexDataSize, const GLuint* indices, const size_t indexCount);
+		void Release() noexcept;
+
+		// Sizes the per-draw cluster scratch and lays the cluster spheres out for FrustumCuller
+		void PrepareClusters();
+
+		// Writes the merged index ranges of the clusters that survive culling into m_DrawCounts and m_DrawOffsets,
+		// offsets counted from firstIndex. Returns the number of ranges
+		GLsizei CullClusters(const glm::mat4& model, const glm::mat4& viewProjection, const glm::vec3& cameraPosition, const GLuint firstIndex, GLsizei& indexCount) const noexcept;
+
+		// Offsets of the geometry inside the bound buffers, zero unless it lives in an arena
+		inline GLint GetBaseVertex() const noexcept { return m_Arena ? m_Arena->GetRange(m_Allocation).baseVertex : 0; }
+		inline GLuint GetFirstIndex() const noexcept { return m_Arena ? m_Arena->GetRange(m_Allocation).firstIndex : 0; }
 
 	private:
 		GLuint m_VAO, m_VBO, m_IBO;
-		GLsizei m_IndexCount;
+		GeometryArena* m_Arena;
+		uint32_t m_Allocation;
+		std::vector<MeshLod> m_Lods;
+		std::vector<MeshCluster> m_Clusters;
+		std::vector<glm::vec4> m_ClusterSpheres; // Center and radius of each cluster
+		mutable std::vector<uint32_t> m_VisibleClusters; // Culling scratch, in cluster order
+		mutable std::vector<GLsizei> m_DrawCounts; // Multi-draw scratch, sized for every cluster
+		mutable std::vector<const void*> m_DrawOffsets;
+		mutable std::vector<GLint> m_DrawBaseVertices;
+		Bounds m_Bounds;
+		glm::mat4 m_DequantizeMatrix;
 	};
 }
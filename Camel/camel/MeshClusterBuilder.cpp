@@ -0,0 +1,197 @@
+#include "MeshClusterBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Camel
+{
+	namespace
+	{
+		// Normal cones wider than this (minimum dot against the axis) never cull anything, disable them
+		constexpr float MIN_CONE_DOT = 0.1f;
+
+		MeshCluster ComputeCluster(const std::vector<Vertex>& vertices, const GLuint* indices, const size_t indexCount, const GLuint indexOffset)
+		{
+			MeshCluster cluster;
+			cluster.indexOffset = indexOffset;
+			cluster.indexCount = (GLsizei)indexCount;
+
+			// Bounding sphere of the referenced vertices
+			glm::vec3 min(std::numeric_limits<float>::max()), max(std::numeric_limits<float>::lowest());
+			for (size_t i = 0; i < indexCount; i++)
+			{
+				min = glm::min(min, vertices[indices[i]].position);
+				max = glm::max(max, vertices[indices[i]].position);
+			}
+
+			cluster.center = (min + max) * 0.5f;
+			float radiusSquared = 0.0f;
+			for (size_t i = 0; i < indexCount; i++)
+			{
+				const glm::vec3 offset = vertices[indices[i]].position - cluster.center;
+				radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+			}
+			cluster.radius = std::sqrt(radiusSquared);
+
+			// Normal cone of the face normals
+			glm::vec3 normals[MeshClusterBuilder::MAX_TRIANGLES];
+			size_t normalCount = 0;
+			glm::vec3 axis(0.0f);
+			for (size_t i = 0; i < indexCount; i += 3)
+			{
+				const glm::vec3& a = vertices[indices[i]].position;
+				const glm::vec3 normal = glm::cross(vertices[indices[i + 1]].position - a, vertices[indices[i + 2]].position - a);
+				const float length = glm::length(normal);
+				if (length > 0.0f)
+				{
+					normals[normalCount] = normal / length;
+					axis += normals[normalCount++];
+				}
+			}
+
+			const float axisLength = glm::length(axis);
+			float minDot = axisLength > 0.0f ? 1.0f : -1.0f;
+			for (size_t i = 0; i < normalCount && axisLength > 0.0f; i++)
+				minDot = std::min(minDot, glm::dot(normals[i], axis / axisLength));
+
+			if (minDot <= MIN_CONE_DOT)
+			{
+				cluster.coneAxis = glm::vec3(0.0f);
+				cluster.coneCutoff = 1.0f;
+			}
+			else
+			{
+				cluster.coneAxis = axis / axisLength;
+				cluster.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+			}
+
+			return cluster;
+		}
+	}
+
+	std::vector<MeshCluster> MeshClusterBuilder::Build(const std::vector<Vertex>& vertices, std::vector<GLuint>& indices, const size_t indexCount)
+	{
+		CAMEL_ASSERT(indexCount % 3 == 0 && indexCount <= indices.size(), "Invalid index count {} for clustering", indexCount);
+
+		const size_t triangleCount = indexCount / 3;
+		const size_t vertexCount = vertices.size();
+
+		// Vertex -> triangle adjacency
+		std::vector<GLuint> adjacencyOffsets(vertexCount + 1, 0);
+		for (size_t i = 0; i < indexCount; i++)
+			adjacencyOffsets[indices[i] + 1]++;
+		for (size_t v = 0; v < vertexCount; v++)
+			adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+
+		std::vector<GLuint> adjacency(indexCount);
+		{
+			std::vector<GLuint> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < indexCount; i++)
+				adjacency[cursor[indices[i]]++] = (GLuint)(i / 3);
+		}
+
+		std::vector<glm::vec3> centroids(triangleCount);
+		for (size_t t = 0; t < triangleCount; t++)
+			centroids[t] = (vertices[indices[t * 3]].position + vertices[indices[t * 3 + 1]].position + vertices[indices[t * 3 + 2]].position) / 3.0f;
+
+		std::vector<bool> isEmitted(triangleCount, false);
+		std::vector<GLuint> vertexCluster(vertexCount, ~0u);
+
+		std::vector<GLuint> result;
+		result.reserve(indexCount);
+
+		std::vector<MeshCluster> clusters;
+		std::vector<GLuint> clusterVertices;
+		size_t clusterTriangles = 0;
+		glm::vec3 centroidSum(0.0f);
+		size_t seed = 0;
+
+		auto emit = [&](const size_t triangle)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				const GLuint vertex = indices[triangle * 3 + k];
+				if (vertexCluster[vertex] != (GLuint)clusters.size())
+				{
+					vertexCluster[vertex] = (GLuint)clusters.size();
+					clusterVertices.push_back(vertex);
+				}
+				result.push_back(vertex);
+			}
+
+			isEmitted[triangle] = true;
+			centroidSum += centroids[triangle];
+			clusterTriangles++;
+		};
+
+		auto finish = [&]()
+		{
+			const size_t offset = result.size() - clusterTriangles * 3;
+			clusters.push_back(ComputeCluster(vertices, result.data() + offset, clusterTriangles * 3, (GLuint)offset));
+			clusterVertices.clear();
+			clusterTriangles = 0;
+			centroidSum = glm::vec3(0.0f);
+		};
+
+		while (true)
+		{
+			// Grow the current cluster with the adjacent triangle adding the fewest vertices, closest to its centroid on ties
+			size_t best = triangleCount;
+			if (clusterTriangles > 0 && clusterTriangles < MAX_TRIANGLES)
+			{
+				const glm::vec3 centroid = centroidSum / (float)clusterTriangles;
+				unsigned int bestExtra = 4;
+				float bestDistance = std::numeric_limits<float>::max();
+
+				for (const GLuint vertex : clusterVertices)
+				{
+					for (GLuint a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; a++)
+					{
+						const GLuint triangle = adjacency[a];
+						if (isEmitted[triangle])
+							continue;
+
+						unsigned int extra = 0;
+						for (int k = 0; k < 3; k++)
+							extra += vertexCluster[indices[triangle * 3 + k]] != (GLuint)clusters.size();
+
+						if (clusterVertices.size() + extra > MAX_VERTICES || extra > bestExtra)
+							continue;
+
+						const glm::vec3 offset = centroids[triangle] - centroid;
+						const float distance = glm::dot(offset, offset);
+						if (extra < bestExtra || distance < bestDistance)
+						{
+							best = triangle;
+							bestExtra = extra;
+							bestDistance = distance;
+						}
+					}
+				}
+			}
+
+			if (best == triangleCount)
+			{
+				// Cluster is full or has no usable neighbours, start a new one from the next triangle in the original order
+				if (clusterTriangles > 0)
+					finish();
+
+				while (seed < triangleCount && isEmitted[seed])
+					seed++;
+
+				if (seed == triangleCount)
+					break;
+
+				best = seed;
+			}
+
+			emit(best);
+		}
+
+		std::copy(result.begin(), result.end(), indices.begin());
+
+		CAMEL_LOG_INFO("Built {} clusters, {} triangles per cluster on average", clusters.size(), clusters.empty() ? 0.0f : (float)triangleCount / clusters.size());
+		return clusters;
+	}
+}
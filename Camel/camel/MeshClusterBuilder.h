@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Core.h"
+#include "Mesh.h"
+
+namespace Camel
+{
+	// Splits an indexed triangle list into small, spatially compact clusters that can be culled individually
+	class MeshClusterBuilder final
+	{
+	public:
+		static constexpr size_t MAX_VERTICES = 64;
+		static constexpr size_t MAX_TRIANGLES = 124;
+
+		// Reorders the first indexCount indices so every cluster is a contiguous range, returns the clusters in order
+		static std::vector<MeshCluster> Build(const std::vector<Vertex>& vertices, std::vector<GLuint>& indices, const size_t indexCount);
+
+	public:
+		MeshClusterBuilder() = delete;
+	};
+}
@@ -0,0 +1,297 @@
+#include "MeshFile.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace Camel
+{
+	namespace
+	{
+		constexpr size_t BLOB_ALIGNMENT = 16;
+
+		struct SourceInfo
+		{
+			uint64_t size;
+			int64_t writeTime;
+		};
+
+		bool QuerySourceInfo(const std::string& sourcePath, SourceInfo& info)
+		{
+			std::error_code error;
+			info.size = (uint64_t)std::filesystem::file_size(sourcePath, error);
+			if (error)
+				return false;
+
+			info.writeTime = (int64_t)std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+			return !error;
+		}
+
+		// 64-bit FNV-1a
+		uint64_t HashBytes(const char* data, const size_t size) noexcept
+		{
+			uint64_t hash = 0xCBF29CE484222325ull;
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= (uint8_t)data[i];
+				hash *= 0x100000001B3ull;
+			}
+			return hash;
+		}
+
+		uint64_t HashFile(const std::string& filePath)
+		{
+			MappedFile file(filePath);
+			return HashBytes(file.GetData(), file.GetSize());
+		}
+
+		// Bytes one attribute occupies in a vertex, 0 for types the cooker never writes
+		uint32_t GetAttributeSize(const MeshFileAttribute& attribute) noexcept
+		{
+			if (attribute.componentCount < 1 || attribute.componentCount > 4)
+				return 0;
+
+			switch (attribute.type)
+			{
+			case GL_INT_2_10_10_10_REV:
+			case GL_UNSIGNED_INT_2_10_10_10_REV:
+				return attribute.componentCount == 4 ? 4 : 0;
+			case GL_FLOAT:
+			case GL_INT:
+			case GL_UNSIGNED_INT:
+				return attribute.componentCount * 4;
+			case GL_HALF_FLOAT:
+			case GL_SHORT:
+			case GL_UNSIGNED_SHORT:
+				return attribute.componentCount * 2;
+			case GL_BYTE:
+			case GL_UNSIGNED_BYTE:
+				return attribute.componentCount;
+			default:
+				return 0;
+			}
+		}
+
+		inline uint64_t AlignUp(const uint64_t value, const uint64_t alignment) noexcept
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+	}
+
+	std::string MeshFile::GetCookedPath(const std::string& sourcePath)
+	{
+		return std::filesystem::path(sourcePath).replace_extension(EXTENSION).string();
+	}
+
+	bool MeshFile::IsUpToDate(const std::string& cookedPath, const std::string& sourcePath)
+	{
+		if (!std::filesystem::exists(cookedPath))
+			return false;
+
+		// Shipped builds may only contain the cooked files
+		SourceInfo source;
+		if (!QuerySourceInfo(sourcePath, source))
+			return true;
+
+		MeshFileHeader header{};
+		std::ifstream file(cookedPath, std::ios::binary);
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			return false;
+
+		if (header.magic != MAGIC || header.version != VERSION || header.sourceSize != source.size)
+			return false;
+
+		if (header.sourceWriteTime == source.writeTime)
+			return true;
+
+		// Timestamps change on checkout or copy, only re-cook if the contents changed too
+		if (header.sourceHash != HashFile(sourcePath))
+			return false;
+
+		// Remember the new timestamp so later launches skip hashing the source again. Read-only installs keep hashing
+		file.close();
+		std::fstream update(cookedPath, std::ios::binary | std::ios::in | std::ios::out);
+		update.seekp(offsetof(MeshFileHeader, sourceWriteTime));
+		update.write(reinterpret_cast<const char*>(&source.writeTime), sizeof(source.writeTime));
+		if (!update)
+			CAMEL_LOG_WARN("Failed to update the source timestamp of cooked mesh {}", cookedPath);
+
+		return true;
+	}
+
+	void MeshFile::Write(const std::string& cookedPath, const std::string& sourcePath, const MeshData& data, const MeshImportSettings& settings)
+	{
+		SourceInfo source;
+		if (!QuerySourceInfo(sourcePath, source))
+		{
+			CAMEL_LOG_ERROR("Failed to query cook source at path: {}", sourcePath);
+			throw std::runtime_error("Failed to query cook source at path: " + sourcePath);
+		}
+
+		const VertexLayout& layout = VertexLayout::Get(settings.vertexFormat);
+		std::vector<MeshFileAttribute> attributes;
+		for (const VertexAttribute& attribute : layout.GetAttributes())
+			attributes.push_back({ attribute.location, (uint32_t)attribute.componentCount, attribute.type, attribute.normalized, attribute.offset });
+
+		std::vector<MeshFileLod> lods;
+		for (const MeshLod& lod : data.lods)
+			lods.push_back({ lod.indexOffset, (uint32_t)lod.indexCount, lod.error });
+		if (lods.empty())
+			lods.push_back({ 0, (uint32_t)data.indices.size(), 0.0f });
+
+		std::vector<MeshFileCluster> clusters;
+		for (const MeshCluster& cluster : data.clusters)
+			clusters.push_back({ cluster.indexOffset, (uint32_t)cluster.indexCount, cluster.center, cluster.radius, cluster.coneAxis, cluster.coneCutoff });
+
+		const Bounds bounds = Bounds::FromPoints(reinterpret_cast<const glm::vec3*>(data.vertices.data()), data.vertices.size(), sizeof(Vertex));
+		const PackedVertices vertices = VertexLayout::Pack(data.vertices, settings.vertexFormat, bounds);
+
+		MeshFileHeader header{};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.sourceHash = HashFile(sourcePath);
+		header.sourceSize = source.size;
+		header.sourceWriteTime = source.writeTime;
+		header.vertexFormat = (uint32_t)settings.vertexFormat;
+		header.optimized = (uint32_t)settings.optimize;
+		header.lodLevels = settings.lodCount;
+		header.lodReduction = settings.lodReduction;
+		header.lodMaxError = settings.lodMaxError;
+		header.clustered = (uint32_t)settings.buildClusters;
+		header.vertexStride = (uint32_t)layout.GetStride();
+		header.attributeCount = (uint32_t)attributes.size();
+		header.lodCount = (uint32_t)lods.size();
+		header.clusterCount = (uint32_t)clusters.size();
+		header.vertexCount = (uint32_t)data.vertices.size();
+		header.indexCount = (uint32_t)data.indices.size();
+		header.vertexDataOffset = AlignUp(sizeof(MeshFileHeader) + attributes.size() * sizeof(MeshFileAttribute) + lods.size() * sizeof(MeshFileLod) + clusters.size() * sizeof(MeshFileCluster), BLOB_ALIGNMENT);
+		header.indexDataOffset = AlignUp(header.vertexDataOffset + vertices.data.size(), BLOB_ALIGNMENT);
+		header.boundsMin = bounds.min;
+		header.boundsMax = bounds.max;
+		header.boundsCenter = bounds.center;
+		header.boundsRadius = bounds.radius;
+		header.dequantizeOffset = glm::vec3(vertices.dequantize[3]);
+		header.dequantizeScale = glm::vec3(vertices.dequantize[0][0], vertices.dequantize[1][1], vertices.dequantize[2][2]);
+
+		std::ofstream file(cookedPath, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			CAMEL_LOG_ERROR("Failed to open cooked mesh for writing at path: {}", cookedPath);
+			throw std::runtime_error("Failed to open cooked mesh for writing at path: " + cookedPath);
+		}
+
+		auto pad = [&file](const uint64_t offset)
+		{
+			static constexpr char zeros[BLOB_ALIGNMENT] = {};
+			file.write(zeros, offset - (uint64_t)file.tellp());
+		};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(attributes.data()), attributes.size() * sizeof(MeshFileAttribute));
+		file.write(reinterpret_cast<const char*>(lods.data()), lods.size() * sizeof(MeshFileLod));
+		file.write(reinterpret_cast<const char*>(clusters.data()), clusters.size() * sizeof(MeshFileCluster));
+		pad(header.vertexDataOffset);
+		file.write(reinterpret_cast<const char*>(vertices.data.data()), vertices.data.size());
+		pad(header.indexDataOffset);
+		file.write(reinterpret_cast<const char*>(data.indices.data()), data.indices.size() * sizeof(GLuint));
+
+		if (!file)
+		{
+			CAMEL_LOG_ERROR("Failed to write cooked mesh at path: {}", cookedPath);
+			throw std::runtime_error("Failed to write cooked mesh at path: " + cookedPath);
+		}
+
+		CAMEL_LOG_INFO("Cooked mesh {} into {} ({} vertices of {} bytes, {} indices, {} LODs)", sourcePath, cookedPath, header.vertexCount, header.vertexStride, header.indexCount, header.lodCount);
+	}
+
+	MeshFile::MeshFile(const std::string& filePath)
+		: m_File(filePath)
+	{
+		if (m_File.GetSize() < sizeof(MeshFileHeader))
+		{
+			CAMEL_LOG_ERROR("Cooked mesh at path {} is truncated", filePath);
+			throw std::runtime_error("Cooked mesh at path " + filePath + " is truncated");
+		}
+
+		const MeshFileHeader& header = GetHeader();
+		if (header.magic != MAGIC || header.version != VERSION)
+		{
+			CAMEL_LOG_ERROR("Cooked mesh at path {} has an unsupported format (version {})", filePath, header.version);
+			throw std::runtime_error("Cooked mesh at path " + filePath + " has an unsupported format");
+		}
+
+		const uint64_t attributesEnd = sizeof(MeshFileHeader) + (uint64_t)header.attributeCount * sizeof(MeshFileAttribute) + (uint64_t)header.lodCount * sizeof(MeshFileLod) + (uint64_t)header.clusterCount * sizeof(MeshFileCluster);
+		const uint64_t vertexDataEnd = header.vertexDataOffset + (uint64_t)header.vertexCount * header.vertexStride;
+		const uint64_t indexDataEnd = header.indexDataOffset + (uint64_t)header.indexCount * sizeof(GLuint);
+		if (attributesEnd > header.vertexDataOffset || vertexDataEnd > header.indexDataOffset || indexDataEnd > m_File.GetSize())
+		{
+			CAMEL_LOG_ERROR("Cooked mesh at path {} is truncated", filePath);
+			throw std::runtime_error("Cooked mesh at path " + filePath + " is truncated");
+		}
+
+		// The blobs go to the GPU as they are, anything reading outside the vertices would fetch out of bounds there
+		const std::span<const MeshFileAttribute> attributes = GetAttributes();
+		const bool hasValidAttributes = std::all_of(attributes.begin(), attributes.end(), [&header](const MeshFileAttribute& attribute)
+		{
+			const uint32_t size = GetAttributeSize(attribute);
+			return size > 0 && (uint64_t)attribute.offset + size <= header.vertexStride;
+		});
+
+		if (!hasValidAttributes)
+		{
+			CAMEL_LOG_ERROR("Cooked mesh at path {} has an invalid vertex layout", filePath);
+			throw std::runtime_error("Cooked mesh at path " + filePath + " has an invalid vertex layout");
+		}
+
+		// Also brings the index blob in from disk, on the loading thread rather than during the upload
+		const GLuint* indices = GetIndexData();
+		const bool hasValidIndices = std::all_of(indices, indices + header.indexCount, [&header](const GLuint index) { return index < header.vertexCount; });
+
+		if (!hasValidIndices)
+		{
+			CAMEL_LOG_ERROR("Cooked mesh at path {} has indices past its {} vertices", filePath, header.vertexCount);
+			throw std::runtime_error("Cooked mesh at path " + filePath + " has indices past its vertices");
+		}
+
+		const std::span<const MeshFileLod> lods = GetLods();
+		const bool hasValidLods = !lods.empty() && std::all_of(lods.begin(), lods.end(), [&header](const MeshFileLod& lod)
+		{
+			return lod.indexCount > 0 && (uint64_t)lod.indexOffset + lod.indexCount <= header.indexCount;
+		});
+
+		if (!hasValidLods)
+		{
+			CAMEL_LOG_ERROR("Cooked mesh at path {} has an invalid LOD table", filePath);
+			throw std::runtime_error("Cooked mesh at path " + filePath + " has an invalid LOD table");
+		}
+
+		const std::span<const MeshFileCluster> clusters = GetClusters();
+		const bool hasValidClusters = std::all_of(clusters.begin(), clusters.end(), [&lods](const MeshFileCluster& cluster)
+		{
+			return (uint64_t)cluster.indexOffset + cluster.indexCount <= lods[0].indexOffset + (uint64_t)lods[0].indexCount;
+		});
+
+		if (!hasValidClusters)
+		{
+			CAMEL_LOG_ERROR("Cooked mesh at path {} has an invalid cluster table", filePath);
+			throw std::runtime_error("Cooked mesh at path " + filePath + " has an invalid cluster table");
+		}
+	}
+
+	VertexLayout MeshFile::GetVertexLayout() const
+	{
+		std::vector<VertexAttribute> attributes;
+		for (const MeshFileAttribute& attribute : GetAttributes())
+			attributes.push_back({ attribute.location, (GLint)attribute.componentCount, attribute.type, (GLboolean)attribute.normalized, attribute.offset });
+
+		return VertexLayout(std::move(attributes), (GLsizei)GetHeader().vertexStride);
+	}
+
+	glm::mat4 MeshFile::GetDequantizeMatrix() const noexcept
+	{
+		const MeshFileHeader& header = GetHeader();
+		return glm::scale(glm::translate(glm::mat4(1.0f), header.dequantizeOffset), header.dequantizeScale);
+	}
+}
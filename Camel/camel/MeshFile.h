@@ -0,0 +1,153 @@
+#pragma once
+
+#include "Core.h"
+#include "Bounds.h"
+#include "MappedFile.h"
+#include "Mesh.h"
+
+#include <span>
+
+namespace Camel
+{
+	// Describes one vertex attribute of the cooked vertex blob, in glVertexAttribPointer terms
+	struct MeshFileAttribute
+	{
+		uint32_t location;
+		uint32_t componentCount;
+		uint32_t type;
+		uint32_t normalized;
+		uint32_t offset;
+	};
+
+	struct MeshFileLod
+	{
+		uint32_t indexOffset;
+		uint32_t indexCount;
+		float error;
+	};
+
+	struct MeshFileCluster
+	{
+		uint32_t indexOffset;
+		uint32_t indexCount;
+		glm::vec3 center;
+		float radius;
+		glm::vec3 coneAxis;
+		float coneCutoff;
+	};
+
+	struct MeshFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+
+		// Identity of the source the file was cooked from
+		uint64_t sourceHash;
+		uint64_t sourceSize;
+		int64_t sourceWriteTime;
+
+		// Import settings the file was cooked with
+		uint32_t vertexFormat;
+		uint32_t optimized;
+		uint32_t lodLevels;
+		float lodReduction;
+		float lodMaxError;
+		uint32_t clustered;
+
+		uint32_t vertexStride;
+		uint32_t attributeCount;
+		uint32_t lodCount;
+		uint32_t clusterCount;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+
+		uint64_t vertexDataOffset;
+		uint64_t indexDataOffset;
+
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		glm::vec3 boundsCenter;
+		float boundsRadius;
+
+		// Quantized positions decode as offset + stored * scale
+		glm::vec3 dequantizeOffset;
+		glm::vec3 dequantizeScale;
+	};
+
+	// Cooked, GPU ready mesh container (.cmesh). The file is laid out as
+	// header | attribute descriptors | LOD table | cluster table | vertex blob | index blob so the blobs can be handed straight to OpenGL.
+	class MeshFile final
+	{
+	public:
+		static constexpr uint32_t MAGIC = 0x48534D43; // "CMSH"
+		static constexpr uint32_t VERSION = 5;
+		static constexpr const char* EXTENSION = ".cmesh";
+
+		static std::string GetCookedPath(const std::string& sourcePath);
+		static bool IsUpToDate(const std::string& cookedPath, const std::string& sourcePath);
+		static void Write(const std::string& cookedPath, const std::string& sourcePath, const MeshData& data, const MeshImportSettings& settings);
+
+	public:
+		MeshFile(const std::string& filePath);
+
+		MeshFile(const MeshFile&) = delete;
+		MeshFile& operator=(const MeshFile&) = delete;
+
+		MeshFile(MeshFile&& other) noexcept = default;
+		MeshFile& operator=(MeshFile&& other) noexcept = default;
+
+		~MeshFile() noexcept = default;
+
+		inline const MeshFileHeader& GetHeader() const noexcept { return *reinterpret_cast<const MeshFileHeader*>(m_File.GetData()); }
+
+		inline std::span<const MeshFileAttribute> GetAttributes() const noexcept
+		{
+			return { reinterpret_cast<const MeshFileAttribute*>(m_File.GetData() + sizeof(MeshFileHeader)), GetHeader().attributeCount };
+		}
+
+		// LOD index ranges, finest first
+		inline std::span<const MeshFileLod> GetLods() const noexcept
+		{
+			return { reinterpret_cast<const MeshFileLod*>(GetAttributes().data() + GetHeader().attributeCount), GetHeader().lodCount };
+		}
+
+		// Clusters of the finest level, empty when the file was cooked without them
+		inline std::span<const MeshFileCluster> GetClusters() const noexcept
+		{
+			return { reinterpret_cast<const MeshFileCluster*>(GetLods().data() + GetHeader().lodCount), GetHeader().clusterCount };
+		}
+
+		inline bool WasCookedWith(const MeshImportSettings& settings) const noexcept
+		{
+			const MeshFileHeader& header = GetHeader();
+			return header.vertexFormat == (uint32_t)settings.vertexFormat && header.optimized == (uint32_t)settings.optimize &&
+				header.lodLevels == settings.lodCount && header.lodReduction == settings.lodReduction && header.lodMaxError == settings.lodMaxError &&
+				header.clustered == (uint32_t)settings.buildClusters;
+		}
+
+		// Reads the vertex and index blobs in from disk, so uploading them does not stall on page faults
+		inline void Prefetch() const noexcept
+		{
+			const MeshFileHeader& header = GetHeader();
+			m_File.Prefetch(header.vertexDataOffset, header.indexDataOffset + GetIndexDataSize() - header.vertexDataOffset);
+		}
+
+		VertexLayout GetVertexLayout() const;
+		glm::mat4 GetDequantizeMatrix() const noexcept;
+
+		inline const void* GetVertexData() const noexcept { return m_File.GetData() + GetHeader().vertexDataOffset; }
+		inline size_t GetVertexDataSize() const noexcept { return (size_t)GetHeader().vertexCount * GetHeader().vertexStride; }
+
+		inline const GLuint* GetIndexData() const noexcept { return reinterpret_cast<const GLuint*>(m_File.GetData() + GetHeader().indexDataOffset); }
+		inline size_t GetIndexDataSize() const noexcept { return (size_t)GetHeader().indexCount * sizeof(GLuint); }
+
+		inline Bounds GetBounds() const noexcept
+		{
+			const MeshFileHeader& header = GetHeader();
+			return { header.boundsMin, header.boundsMax, header.boundsCenter, header.boundsRadius };
+		}
+
+	private:
+		MappedFile m_File;
+	};
+}
@@ -0,0 +1,368 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Camel
+{
+	namespace
+	{
+		// Tuning constants from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+		constexpr int FORSYTH_CACHE_SIZE = 32;
+		constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+		constexpr float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+		constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+		constexpr float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+		constexpr int FORSYTH_MAX_VALENCE = 64;
+
+		struct ForsythScoreTable
+		{
+			float cache[FORSYTH_CACHE_SIZE];
+			float valence[FORSYTH_MAX_VALENCE];
+
+			ForsythScoreTable()
+			{
+				for (int i = 0; i < FORSYTH_CACHE_SIZE; i++)
+				{
+					// The three vertices of the last triangle get a fixed score so strips don't just flip-flop
+					if (i < 3)
+						cache[i] = FORSYTH_LAST_TRIANGLE_SCORE;
+					else
+						cache[i] = std::pow(1.0f - (float)(i - 3) / (FORSYTH_CACHE_SIZE - 3), FORSYTH_CACHE_DECAY_POWER);
+				}
+
+				valence[0] = 0.0f;
+				for (int i = 1; i < FORSYTH_MAX_VALENCE; i++)
+					valence[i] = FORSYTH_VALENCE_BOOST_SCALE * std::pow((float)i, -FORSYTH_VALENCE_BOOST_POWER);
+			}
+		};
+
+		inline float ForsythVertexScore(const ForsythScoreTable& table, const int cachePosition, const unsigned int remainingValence) noexcept
+		{
+			// No triangles left to use this vertex
+			if (remainingValence == 0)
+				return -1.0f;
+
+			const float cacheScore = cachePosition >= 0 ? table.cache[cachePosition] : 0.0f;
+			return cacheScore + table.valence[std::min<unsigned int>(remainingValence, FORSYTH_MAX_VALENCE - 1)];
+		}
+
+		// Small FIFO cache simulation, returns how many of the triangle's vertices were misses
+		class FifoCache final
+		{
+		public:
+			FifoCache(const size_t vertexCount, const unsigned int cacheSize)
+				: m_Timestamps(vertexCount, 0), m_Time(cacheSize + 1), m_CacheSize(cacheSize)
+			{}
+
+			inline unsigned int Process(const GLuint a, const GLuint b, const GLuint c) noexcept
+			{
+				return Touch(a) + Touch(b) + Touch(c);
+			}
+
+			// Forgets all cached vertices
+			inline void Flush() noexcept { m_Time += m_CacheSize + 1; }
+
+		private:
+			inline unsigned int Touch(const GLuint vertex) noexcept
+			{
+				// A vertex is cached if fewer than cacheSize misses happened since it was loaded
+				if (m_Time - m_Timestamps[vertex] > m_CacheSize)
+				{
+					m_Timestamps[vertex] = m_Time++;
+					return 1;
+				}
+				return 0;
+			}
+
+		private:
+			std::vector<unsigned int> m_Timestamps;
+			unsigned int m_Time;
+			unsigned int m_CacheSize;
+		};
+	}
+
+	void MeshOptimizer::Optimize(MeshData& mesh, const float overdrawThreshold)
+	{
+		const VertexCacheStatistics before = AnalyzeVertexCache(mesh.indices, mesh.vertices.size());
+
+		OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+		OptimizeOverdraw(mesh.indices, mesh.vertices, overdrawThreshold);
+		OptimizeVertexFetch(mesh.vertices, mesh.indices);
+
+		const VertexCacheStatistics after = AnalyzeVertexCache(mesh.indices, mesh.vertices.size());
+
+		CAMEL_LOG_INFO("Optimized mesh: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f} (cache size {})", before.acmr, after.acmr, before.atvr, after.atvr, CACHE_SIZE);
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(std::vector<GLuint>& indices, const size_t vertexCount)
+	{
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+			return;
+
+		static const ForsythScoreTable scoreTable;
+
+		// Vertex -> triangle adjacency in CSR form
+		std::vector<unsigned int> valence(vertexCount, 0);
+		for (const GLuint index : indices)
+			valence[index]++;
+
+		std::vector<size_t> adjacencyOffsets(vertexCount + 1, 0);
+		for (size_t v = 0; v < vertexCount; v++)
+			adjacencyOffsets[v + 1] = adjacencyOffsets[v] + valence[v];
+
+		std::vector<unsigned int> adjacency(indices.size());
+		{
+			std::vector<size_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); i++)
+				adjacency[cursor[indices[i]]++] = (unsigned int)(i / 3);
+		}
+
+		// Remaining valence is kept as the live prefix of each adjacency list
+		std::vector<unsigned int> remainingValence(valence);
+		std::vector<int> cachePosition(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+			vertexScores[v] = ForsythVertexScore(scoreTable, -1, remainingValence[v]);
+
+		std::vector<float> triangleScores(triangleCount);
+		for (size_t t = 0; t < triangleCount; t++)
+			triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<GLuint> output;
+		output.reserve(indices.size());
+
+		// Cache holds up to FORSYTH_CACHE_SIZE entries plus the 3 pushed by the current triangle
+		std::vector<GLuint> cache, newCache;
+		cache.reserve(FORSYTH_CACHE_SIZE + 3);
+		newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+		size_t inputCursor = 0;
+		long long bestTriangle = -1;
+
+		for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+		{
+			// Dead end, continue with the next triangle in input order
+			if (bestTriangle < 0)
+			{
+				while (emitted[inputCursor])
+					inputCursor++;
+				bestTriangle = (long long)inputCursor;
+			}
+
+			const size_t triangle = (size_t)bestTriangle;
+			const GLuint* corners = &indices[triangle * 3];
+			output.insert(output.end(), corners, corners + 3);
+			emitted[triangle] = true;
+
+			// Move the triangle's vertices to the front of the LRU cache and drop the triangle from their adjacency
+			newCache.assign(corners, corners + 3);
+			for (const GLuint vertex : cache)
+				if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2])
+					newCache.push_back(vertex);
+
+			for (int i = 0; i < 3; i++)
+			{
+				const GLuint vertex = corners[i];
+				unsigned int* list = &adjacency[adjacencyOffsets[vertex]];
+				unsigned int& count = remainingValence[vertex];
+				for (unsigned int j = 0; j < count; j++)
+				{
+					if (list[j] == triangle)
+					{
+						std::swap(list[j], list[count - 1]);
+						count--;
+						break;
+					}
+				}
+			}
+
+			// Rescore cached vertices and the triangles they touch, picking the next best triangle
+			bestTriangle = -1;
+			float bestScore = -1.0f;
+
+			for (size_t i = 0; i < newCache.size(); i++)
+			{
+				const GLuint vertex = newCache[i];
+				cachePosition[vertex] = i < (size_t)FORSYTH_CACHE_SIZE ? (int)i : -1;
+
+				const float score = ForsythVertexScore(scoreTable, cachePosition[vertex], remainingValence[vertex]);
+				const float delta = score - vertexScores[vertex];
+				vertexScores[vertex] = score;
+
+				const unsigned int* list = &adjacency[adjacencyOffsets[vertex]];
+				for (unsigned int j = 0; j < remainingValence[vertex]; j++)
+					triangleScores[list[j]] += delta;
+			}
+
+			for (size_t i = 0; i < newCache.size() && i < (size_t)FORSYTH_CACHE_SIZE; i++)
+			{
+				const GLuint vertex = newCache[i];
+				const unsigned int* list = &adjacency[adjacencyOffsets[vertex]];
+				for (unsigned int j = 0; j < remainingValence[vertex]; j++)
+				{
+					if (triangleScores[list[j]] > bestScore)
+					{
+						bestScore = triangleScores[list[j]];
+						bestTriangle = list[j];
+					}
+				}
+			}
+
+			if (newCache.size() > (size_t)FORSYTH_CACHE_SIZE)
+				newCache.resize(FORSYTH_CACHE_SIZE);
+			cache.swap(newCache);
+		}
+
+		indices.swap(output);
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(std::vector<GLuint>& indices, const std::vector<Vertex>& vertices, const float threshold)
+	{
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+			return;
+
+		// Hard boundaries: triangles where the cache effectively restarts (all three vertices miss)
+		std::vector<size_t> hardClusters;
+		{
+			FifoCache cache(vertices.size(), CACHE_SIZE);
+			for (size_t t = 0; t < triangleCount; t++)
+				if (cache.Process(indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2]) == 3)
+					hardClusters.push_back(t);
+		}
+		if (hardClusters.empty() || hardClusters[0] != 0)
+			hardClusters.insert(hardClusters.begin(), 0);
+		hardClusters.push_back(triangleCount);
+
+		// Soft boundaries: split hard clusters further wherever the running ACMR is within threshold of the cluster's
+		std::vector<size_t> clusters;
+		{
+			FifoCache cache(vertices.size(), CACHE_SIZE);
+			for (size_t c = 0; c + 1 < hardClusters.size(); c++)
+			{
+				const size_t begin = hardClusters[c], end = hardClusters[c + 1];
+
+				cache.Flush();
+				unsigned int clusterMisses = 0;
+				for (size_t t = begin; t < end; t++)
+					clusterMisses += cache.Process(indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2]);
+				const float clusterThreshold = threshold * (float)clusterMisses / (float)(end - begin);
+
+				clusters.push_back(begin);
+				cache.Flush();
+				unsigned int runningMisses = 0, runningTriangles = 0;
+				for (size_t t = begin; t < end; t++)
+				{
+					runningMisses += cache.Process(indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2]);
+					runningTriangles++;
+
+					if (t + 1 < end && (float)runningMisses / (float)runningTriangles <= clusterThreshold)
+					{
+						clusters.push_back(t + 1);
+						cache.Flush();
+						runningMisses = runningTriangles = 0;
+					}
+				}
+			}
+		}
+		clusters.push_back(triangleCount);
+
+		const size_t clusterCount = clusters.size() - 1;
+
+		// Area weighted centroid of the whole mesh
+		glm::vec3 meshCentroid(0.0f);
+		float meshArea = 0.0f;
+		std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+		std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+
+		for (size_t c = 0; c < clusterCount; c++)
+		{
+			float clusterArea = 0.0f;
+			for (size_t t = clusters[c]; t < clusters[c + 1]; t++)
+			{
+				const glm::vec3& a = vertices[indices[t * 3]].position;
+				const glm::vec3& b = vertices[indices[t * 3 + 1]].position;
+				const glm::vec3& p = vertices[indices[t * 3 + 2]].position;
+
+				const glm::vec3 normal = glm::cross(b - a, p - a);
+				const float area = glm::length(normal);
+				const glm::vec3 centroid = (a + b + p) / 3.0f;
+
+				clusterCentroids[c] += centroid * area;
+				clusterNormals[c] += normal;
+				clusterArea += area;
+			}
+
+			meshCentroid += clusterCentroids[c];
+			meshArea += clusterArea;
+
+			clusterCentroids[c] = clusterArea > 0.0f ? clusterCentroids[c] / clusterArea : vertices[indices[clusters[c] * 3]].position;
+			const float normalLength = glm::length(clusterNormals[c]);
+			clusterNormals[c] = normalLength > 0.0f ? clusterNormals[c] / normalLength : glm::vec3(0.0f);
+		}
+
+		if (meshArea > 0.0f)
+			meshCentroid /= meshArea;
+
+		// The winding convention decides which side the geometric normal points to, orient it outwards on average
+		float orientation = 0.0f;
+		for (size_t c = 0; c < clusterCount; c++)
+			orientation += glm::dot(clusterCentroids[c] - meshCentroid, clusterNormals[c]);
+		const float outward = orientation < 0.0f ? -1.0f : 1.0f;
+
+		// Draw outward facing clusters first, so they are likely to occlude what is drawn after them
+		std::vector<float> sortKeys(clusterCount);
+		for (size_t c = 0; c < clusterCount; c++)
+			sortKeys[c] = outward * glm::dot(clusterCentroids[c] - meshCentroid, clusterNormals[c]);
+
+		std::vector<size_t> order(clusterCount);
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&sortKeys](const size_t a, const size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+		std::vector<GLuint> output;
+		output.reserve(indices.size());
+		for (const size_t c : order)
+			output.insert(output.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+
+		indices.swap(output);
+	}
+
+	void MeshOptimizer::OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<GLuint>& indices)
+	{
+		constexpr GLuint UNUSED = ~0u;
+		std::vector<GLuint> remap(vertices.size(), UNUSED);
+
+		std::vector<Vertex> output;
+		output.reserve(vertices.size());
+
+		for (GLuint& index : indices)
+		{
+			if (remap[index] == UNUSED)
+			{
+				remap[index] = (GLuint)output.size();
+				output.push_back(vertices[index]);
+			}
+			index = remap[index];
+		}
+
+		vertices.swap(output);
+	}
+
+	VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const std::vector<GLuint>& indices, const size_t vertexCount, const unsigned int cacheSize)
+	{
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0 || vertexCount == 0)
+			return { 0.0f, 0.0f };
+
+		FifoCache cache(vertexCount, cacheSize);
+		size_t misses = 0;
+		for (size_t t = 0; t < triangleCount; t++)
+			misses += cache.Process(indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2]);
+
+		return { (float)misses / (float)triangleCount, (float)misses / (float)vertexCount };
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Core.h"
+#include "Mesh.h"
+
+namespace Camel
+{
+	struct VertexCacheStatistics
+	{
+		float acmr; // Average cache miss ratio, transformed vertices per triangle (0.5 is ideal, 3 is worst)
+		float atvr; // Average transformed vertex ratio, transformed vertices per vertex (1 is ideal)
+	};
+
+	// Reorders indexed triangle lists for the GPU: post-transform vertex cache locality (Forsyth),
+	// overdraw (cluster sorting in the spirit of Tipsify) and linear vertex fetch.
+	class MeshOptimizer final
+	{
+	public:
+		// Size of the simulated FIFO cache used for statistics and cluster splitting
+		static constexpr unsigned int CACHE_SIZE = 16;
+
+		// Runs all passes in order and logs the vertex cache statistics before and after
+		static void Optimize(MeshData& mesh, const float overdrawThreshold = 1.05f);
+
+		static void OptimizeVertexCache(std::vector<GLuint>& indices, const size_t vertexCount);
+
+		// Expects indices already optimized for the vertex cache, threshold bounds how much ACMR may degrade
+		static void OptimizeOverdraw(std::vector<GLuint>& indices, const std::vector<Vertex>& vertices, const float threshold = 1.05f);
+
+		// Renumbers vertices in order of first use and drops unreferenced ones
+		static void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<GLuint>& indices);
+
+		static VertexCacheStatistics AnalyzeVertexCache(const std::vector<GLuint>& indices, const size_t vertexCount, const unsigned int cacheSize = CACHE_SIZE);
+
+	public:
+		MeshOptimizer() = delete;
+	};
+}
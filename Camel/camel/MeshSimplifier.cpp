@@ -0,0 +1,373 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace Camel
+{
+	namespace
+	{
+		// Border edges are held in place by planes perpendicular to the surface, weighted well above the surface planes
+		constexpr double BORDER_WEIGHT = 10.0;
+
+		// Fraction of the remaining triangles a single pass may remove, keeps the per-pass adjacency reasonably fresh
+		constexpr double MAX_PASS_REDUCTION = 0.25;
+
+		constexpr GLuint INVALID_INDEX = ~0u;
+
+		// Symmetric 4x4 quadric of plane equations, with the accumulated plane area as weight
+		struct Quadric
+		{
+			double a2 = 0, b2 = 0, c2 = 0, d2 = 0;
+			double ab = 0, ac = 0, ad = 0, bc = 0, bd = 0, cd = 0;
+			double weight = 0;
+
+			static inline Quadric FromPlane(const glm::dvec3& normal, const double distance, const double weight) noexcept
+			{
+				Quadric q;
+				q.a2 = normal.x * normal.x * weight;
+				q.b2 = normal.y * normal.y * weight;
+				q.c2 = normal.z * normal.z * weight;
+				q.d2 = distance * distance * weight;
+				q.ab = normal.x * normal.y * weight;
+				q.ac = normal.x * normal.z * weight;
+				q.ad = normal.x * distance * weight;
+				q.bc = normal.y * normal.z * weight;
+				q.bd = normal.y * distance * weight;
+				q.cd = normal.z * distance * weight;
+				q.weight = weight;
+				return q;
+			}
+
+			inline void operator+=(const Quadric& other) noexcept
+			{
+				a2 += other.a2; b2 += other.b2; c2 += other.c2; d2 += other.d2;
+				ab += other.ab; ac += other.ac; ad += other.ad;
+				bc += other.bc; bd += other.bd; cd += other.cd;
+				weight += other.weight;
+			}
+
+			// Weighted mean squared distance of p to the accumulated planes
+			inline double Evaluate(const glm::dvec3& p) const noexcept
+			{
+				const double error =
+					a2 * p.x * p.x + b2 * p.y * p.y + c2 * p.z * p.z + d2 +
+					2.0 * (ab * p.x * p.y + ac * p.x * p.z + bc * p.y * p.z + ad * p.x + bd * p.y + cd * p.z);
+				return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+			}
+		};
+
+		struct Collapse
+		{
+			GLuint from, to; // Positions
+			double cost;
+		};
+
+		inline uint64_t EdgeKey(const GLuint a, const GLuint b) noexcept
+		{
+			return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+		}
+
+		struct PositionHash
+		{
+			inline size_t operator()(const glm::vec3& p) const noexcept
+			{
+				// Adding zero folds -0 into +0, they compare equal so they must hash equal
+				const glm::vec3 folded = p + glm::vec3(0.0f);
+				uint32_t bits[3];
+				std::memcpy(bits, &folded, sizeof(bits));
+				return (size_t)(bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u);
+			}
+		};
+	}
+
+	std::vector<GLuint> MeshSimplifier::Simplify(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, const size_t targetIndexCount, const float targetError, float* resultError)
+	{
+		if (resultError)
+			*resultError = 0.0f;
+
+		if (indices.size() <= targetIndexCount || vertices.empty())
+			return indices;
+
+		// Weld vertices by position, each position owns one or more wedges (vertices with different attributes)
+		std::vector<GLuint> vertexPosition(vertices.size());
+		std::vector<glm::dvec3> positions;
+		{
+			std::unordered_map<glm::vec3, GLuint, PositionHash> unique;
+			unique.reserve(vertices.size());
+			for (size_t v = 0; v < vertices.size(); v++)
+			{
+				auto [found, inserted] = unique.try_emplace(vertices[v].position, (GLuint)positions.size());
+				if (inserted)
+					positions.push_back(glm::dvec3(vertices[v].position));
+				vertexPosition[v] = found->second;
+			}
+		}
+
+		const size_t positionCount = positions.size();
+
+		// Work in a space normalized by the bounding radius so errors are relative
+		const Bounds bounds = Bounds::FromPoints(reinterpret_cast<const glm::vec3*>(vertices.data()), vertices.size(), sizeof(Vertex));
+		const double scale = bounds.radius > 0.0f ? 1.0 / bounds.radius : 1.0;
+		for (glm::dvec3& position : positions)
+			position = (position - glm::dvec3(bounds.center)) * scale;
+
+		std::vector<GLuint> triangles(indices);
+
+		// Surface and border quadrics, plus locks for non-manifold geometry
+		std::vector<Quadric> quadrics(positionCount);
+		std::vector<bool> isBorder(positionCount, false), isLocked(positionCount, false);
+		{
+			std::unordered_map<uint64_t, std::pair<unsigned int, size_t>> edges; // Edge -> (use count, last triangle)
+			edges.reserve(triangles.size());
+
+			for (size_t t = 0; t < triangles.size() / 3; t++)
+			{
+				const GLuint p[3] = { vertexPosition[triangles[t * 3]], vertexPosition[triangles[t * 3 + 1]], vertexPosition[triangles[t * 3 + 2]] };
+				if (p[0] == p[1] || p[1] == p[2] || p[0] == p[2])
+					continue;
+
+				const glm::dvec3 normal = glm::cross(positions[p[1]] - positions[p[0]], positions[p[2]] - positions[p[0]]);
+				const double area = glm::length(normal);
+				if (area > 0.0)
+				{
+					const glm::dvec3 unitNormal = normal / area;
+					const Quadric plane = Quadric::FromPlane(unitNormal, -glm::dot(unitNormal, positions[p[0]]), area);
+					for (int i = 0; i < 3; i++)
+						quadrics[p[i]] += plane;
+				}
+
+				for (int i = 0; i < 3; i++)
+				{
+					auto& edge = edges[EdgeKey(p[i], p[(i + 1) % 3])];
+					edge.first++;
+					edge.second = t;
+				}
+			}
+
+			for (const auto& [key, edge] : edges)
+			{
+				const GLuint a = (GLuint)(key >> 32), b = (GLuint)(key & 0xFFFFFFFF);
+
+				if (edge.first > 2)
+				{
+					isLocked[a] = isLocked[b] = true;
+				}
+				else if (edge.first == 1)
+				{
+					isBorder[a] = isBorder[b] = true;
+
+					const size_t t = edge.second;
+					const glm::dvec3 faceNormal = glm::cross(
+						positions[vertexPosition[triangles[t * 3 + 1]]] - positions[vertexPosition[triangles[t * 3]]],
+						positions[vertexPosition[triangles[t * 3 + 2]]] - positions[vertexPosition[triangles[t * 3]]]);
+					const glm::dvec3 edgeDirection = positions[b] - positions[a];
+					const glm::dvec3 borderNormal = glm::cross(edgeDirection, faceNormal);
+					const double length = glm::length(borderNormal);
+					if (length > 0.0)
+					{
+						const glm::dvec3 unitNormal = borderNormal / length;
+						const Quadric plane = Quadric::FromPlane(unitNormal, -glm::dot(unitNormal, positions[a]), glm::dot(edgeDirection, edgeDirection) * BORDER_WEIGHT);
+						quadrics[a] += plane;
+						quadrics[b] += plane;
+					}
+				}
+			}
+		}
+
+		const double maxCost = (double)targetError * targetError;
+		double reachedCost = 0.0;
+		size_t triangleCount = triangles.size() / 3;
+
+		std::vector<size_t> adjacencyOffsets(positionCount + 1);
+		std::vector<GLuint> adjacency;
+		std::vector<Collapse> collapses;
+		std::vector<bool> touched(positionCount);
+		std::vector<GLuint> wedgeRemap(vertices.size());
+		std::unordered_map<uint64_t, unsigned int> edgeUses;
+
+		while (triangleCount * 3 > targetIndexCount)
+		{
+			// Drop triangles that collapsed onto an edge or a point
+			size_t liveCount = 0;
+			for (size_t t = 0; t < triangleCount; t++)
+			{
+				const GLuint* corners = &triangles[t * 3];
+				const GLuint a = vertexPosition[corners[0]], b = vertexPosition[corners[1]], c = vertexPosition[corners[2]];
+				if (a == b || b == c || a == c)
+					continue;
+
+				std::memmove(&triangles[liveCount * 3], corners, 3 * sizeof(GLuint));
+				liveCount++;
+			}
+			triangleCount = liveCount;
+			triangles.resize(triangleCount * 3);
+
+			if (triangleCount * 3 <= targetIndexCount)
+				break;
+
+			// Position -> triangle adjacency for this pass
+			std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+			for (const GLuint corner : triangles)
+				adjacencyOffsets[vertexPosition[corner] + 1]++;
+			for (size_t p = 0; p < positionCount; p++)
+				adjacencyOffsets[p + 1] += adjacencyOffsets[p];
+
+			adjacency.resize(triangles.size());
+			{
+				std::vector<size_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+				for (size_t i = 0; i < triangles.size(); i++)
+					adjacency[cursor[vertexPosition[triangles[i]]]++] = (GLuint)(i / 3);
+			}
+
+			// Border edges are the ones used by a single triangle
+			edgeUses.clear();
+			for (size_t t = 0; t < triangleCount; t++)
+				for (int i = 0; i < 3; i++)
+					edgeUses[EdgeKey(vertexPosition[triangles[t * 3 + i]], vertexPosition[triangles[t * 3 + (i + 1) % 3]])]++;
+
+			// Candidate collapses in both directions of every edge
+			collapses.clear();
+			for (const auto& [key, uses] : edgeUses)
+			{
+				const GLuint a = (GLuint)(key >> 32), b = (GLuint)(key & 0xFFFFFFFF);
+				const bool isBorderEdge = uses == 1;
+
+				for (int direction = 0; direction < 2; direction++)
+				{
+					const GLuint from = direction == 0 ? a : b;
+					const GLuint to = direction == 0 ? b : a;
+
+					// Border vertices may only slide along the border
+					if (isLocked[from] || (isBorder[from] && !isBorderEdge))
+						continue;
+
+					Quadric combined = quadrics[from];
+					combined += quadrics[to];
+					collapses.push_back({ from, to, combined.Evaluate(positions[to]) });
+				}
+			}
+
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+			std::fill(touched.begin(), touched.end(), false);
+			const size_t passTarget = std::max(targetIndexCount / 3, (size_t)(triangleCount * (1.0 - MAX_PASS_REDUCTION)));
+			size_t remaining = triangleCount;
+			size_t performed = 0;
+
+			for (const Collapse& collapse : collapses)
+			{
+				if (collapse.cost > maxCost || remaining <= passTarget)
+					break;
+
+				if (touched[collapse.from] || touched[collapse.to])
+					continue;
+
+				const GLuint* around = &adjacency[adjacencyOffsets[collapse.from]];
+				const size_t aroundCount = adjacencyOffsets[collapse.from + 1] - adjacencyOffsets[collapse.from];
+
+				// Every wedge of from must map onto the wedge of to it shares a triangle with, otherwise the collapse would cross a seam
+				bool isValid = true;
+				size_t removedTriangles = 0;
+
+				for (size_t i = 0; i < aroundCount && isValid; i++)
+				{
+					const GLuint* corners = &triangles[around[i] * 3];
+					for (int k = 0; k < 3; k++)
+						if (vertexPosition[corners[k]] == collapse.from)
+							wedgeRemap[corners[k]] = INVALID_INDEX;
+				}
+
+				for (size_t i = 0; i < aroundCount && isValid; i++)
+				{
+					const GLuint* corners = &triangles[around[i] * 3];
+
+					GLuint fromWedge = INVALID_INDEX, toWedge = INVALID_INDEX;
+					for (int k = 0; k < 3; k++)
+					{
+						if (vertexPosition[corners[k]] == collapse.from)
+							fromWedge = corners[k];
+						else if (vertexPosition[corners[k]] == collapse.to)
+							toWedge = corners[k];
+					}
+
+					if (toWedge == INVALID_INDEX)
+						continue;
+
+					removedTriangles++;
+					if (wedgeRemap[fromWedge] == INVALID_INDEX)
+						wedgeRemap[fromWedge] = toWedge;
+					else if (wedgeRemap[fromWedge] != toWedge)
+						isValid = false;
+				}
+
+				// Reject when any triangle would flip or degenerate, or a wedge has nothing to map onto
+				for (size_t i = 0; i < aroundCount && isValid; i++)
+				{
+					const GLuint* corners = &triangles[around[i] * 3];
+
+					glm::dvec3 before[3], after[3];
+					bool hasTo = false;
+					for (int k = 0; k < 3; k++)
+					{
+						const GLuint position = vertexPosition[corners[k]];
+						hasTo |= position == collapse.to;
+						before[k] = positions[position];
+						after[k] = position == collapse.from ? positions[collapse.to] : before[k];
+
+						if (position == collapse.from && wedgeRemap[corners[k]] == INVALID_INDEX)
+							isValid = false;
+					}
+
+					if (hasTo || !isValid)
+						continue;
+
+					const glm::dvec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+					const glm::dvec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+					if (glm::dot(normalBefore, normalAfter) <= 1e-3 * glm::length(normalBefore) * glm::length(normalAfter))
+						isValid = false;
+				}
+
+				if (!isValid)
+					continue;
+
+				// Apply, triangles that contained both ends are dropped at the start of the next pass
+				for (size_t i = 0; i < aroundCount; i++)
+				{
+					GLuint* corners = &triangles[around[i] * 3];
+					for (int k = 0; k < 3; k++)
+					{
+						touched[vertexPosition[corners[k]]] = true;
+						if (vertexPosition[corners[k]] == collapse.from)
+							corners[k] = wedgeRemap[corners[k]];
+					}
+				}
+
+				quadrics[collapse.to] += quadrics[collapse.from];
+				reachedCost = std::max(reachedCost, collapse.cost);
+				remaining -= removedTriangles;
+				performed++;
+			}
+
+			if (performed == 0)
+				break;
+		}
+
+		// Final cleanup of degenerate triangles
+		std::vector<GLuint> result;
+		result.reserve(triangles.size());
+		for (size_t t = 0; t < triangles.size() / 3; t++)
+		{
+			const GLuint* corners = &triangles[t * 3];
+			const GLuint a = vertexPosition[corners[0]], b = vertexPosition[corners[1]], c = vertexPosition[corners[2]];
+			if (a != b && b != c && a != c)
+				result.insert(result.end(), corners, corners + 3);
+		}
+
+		if (resultError)
+			*resultError = (float)std::sqrt(reachedCost);
+
+		return result;
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Core.h"
+#include "Mesh.h"
+
+namespace Camel
+{
+	// Quadric error metric simplification by half-edge collapse. Vertices are never moved or created,
+	// so simplified index lists keep referencing the original vertex buffer. Collapses only happen along
+	// attribute seams and mesh borders, never across them.
+	class MeshSimplifier final
+	{
+	public:
+		// Reduces indices towards targetIndexCount without exceeding targetError, which is relative to the mesh
+		// bounding radius. The relative error actually reached is written to resultError when provided.
+		static std::vector<GLuint> Simplify(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, const size_t targetIndexCount, const float targetError, float* resultError = nullptr);
+
+	public:
+		MeshSimplifier() = delete;
+	};
+}
@@ -0,0 +1,562 @@
+#include "ObjParser.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <thread>
+
+namespace Camel
+{
+	namespace
+	{
+		// Chunks smaller than this are not worth a thread of their own
+		constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+
+		constexpr int MISSING_INDEX = std::numeric_limits<int>::min();
+
+		constexpr uint8_t RELATIVE_POSITION = 1 << 0;
+		constexpr uint8_t RELATIVE_TEXCOORD = 1 << 1;
+		constexpr uint8_t RELATIVE_NORMAL = 1 << 2;
+
+		// A face corner as parsed inside a chunk. Negative obj indices depend on how many attributes the
+		// preceding chunks declared, so they are stored relative to the chunk and resolved when merging.
+		struct ObjRawCorner
+		{
+			int position, texCoord, normal;
+			uint8_t relativeMask;
+		};
+
+		// A fully resolved v/vt/vn reference as 0-based indices (-1 when the attribute is absent)
+		struct ObjCorner
+		{
+			int position, texCoord, normal;
+
+			inline bool operator==(const ObjCorner& other) const noexcept
+			{
+				return position == other.position && texCoord == other.texCoord && normal == other.normal;
+			}
+		};
+
+		struct ObjChunk
+		{
+			const char* begin = nullptr;
+			const char* end = nullptr;
+
+			// Parsed
+			std::vector<glm::vec3> positions, normals;
+			std::vector<glm::vec2> texCoords;
+			std::vector<ObjRawCorner> corners;
+			std::vector<uint32_t> faceSizes;
+
+			// Merged
+			size_t positionOffset = 0, texCoordOffset = 0, normalOffset = 0, indexOffset = 0;
+			std::vector<ObjCorner> resolvedCorners;
+			std::vector<GLuint> cornerVertices;
+			size_t degenerateFaceCount = 0;
+			bool hasMissingAttributes = false;
+
+			std::exception_ptr error;
+		};
+
+		// Runs func on every chunk, one job (or without a job system one thread) per chunk, rethrowing the first failure on the calling thread
+		template<typename Func>
+		void ForEachChunk(std::vector<ObjChunk>& chunks, JobSystem* jobSystem, const Func& func)
+		{
+			auto run = [&](ObjChunk& chunk)
+			{
+				try
+				{
+					func(chunk);
+				}
+				catch (...)
+				{
+					chunk.error = std::current_exception();
+				}
+			};
+
+			if (jobSystem)
+			{
+				jobSystem->ParallelFor(chunks.size(), 1, [&](const size_t begin, const size_t end)
+				{
+					for (size_t i = begin; i < end; i++)
+						run(chunks[i]);
+				});
+			}
+			else
+			{
+				std::vector<std::thread> workers;
+				for (size_t i = 1; i < chunks.size(); i++)
+					workers.emplace_back(run, std::ref(chunks[i]));
+				run(chunks[0]);
+				for (std::thread& worker : workers)
+					worker.join();
+			}
+
+			for (const ObjChunk& chunk : chunks)
+				if (chunk.error)
+					std::rethrow_exception(chunk.error);
+		}
+
+		// Open addressing (linear probing) map from ObjCorner to vertex index, keys are stored inline so probing stays within one cache line
+		class ObjCornerMap final
+		{
+		public:
+			ObjCornerMap(const size_t expectedCount)
+				: m_Count(0)
+			{
+				size_t capacity = 1024;
+				while (capacity < expectedCount * 2)
+					capacity <<= 1;
+				m_Slots.assign(capacity, Slot{ {}, EMPTY_SLOT });
+			}
+
+			// Returns the vertex index of corner, inserting it as the next vertex when not found
+			inline GLuint FindOrInsert(const ObjCorner& corner, bool& inserted)
+			{
+				if ((m_Count + 1) * 2 > m_Slots.size())
+					Grow();
+
+				const size_t mask = m_Slots.size() - 1;
+				size_t slot = Hash(corner) & mask;
+				while (m_Slots[slot].index != EMPTY_SLOT)
+				{
+					if (m_Slots[slot].corner == corner)
+					{
+						inserted = false;
+						return m_Slots[slot].index;
+					}
+					slot = (slot + 1) & mask;
+				}
+
+				m_Slots[slot] = { corner, (GLuint)m_Count };
+				inserted = true;
+				return (GLuint)m_Count++;
+			}
+
+		private:
+			struct Slot
+			{
+				ObjCorner corner;
+				GLuint index;
+			};
+
+			static inline size_t Hash(const ObjCorner& corner) noexcept
+			{
+				uint64_t hash = (uint64_t)(uint32_t)corner.position;
+				hash = hash * 0x9E3779B97F4A7C15ull ^ (uint64_t)(uint32_t)corner.texCoord;
+				hash = hash * 0x9E3779B97F4A7C15ull ^ (uint64_t)(uint32_t)corner.normal;
+				hash *= 0x9E3779B97F4A7C15ull;
+				return (size_t)(hash ^ (hash >> 32));
+			}
+
+			void Grow()
+			{
+				std::vector<Slot> oldSlots(m_Slots.size() * 2, Slot{ {}, EMPTY_SLOT });
+				oldSlots.swap(m_Slots);
+
+				const size_t mask = m_Slots.size() - 1;
+				for (const Slot& oldSlot : oldSlots)
+				{
+					if (oldSlot.index == EMPTY_SLOT)
+						continue;
+
+					size_t slot = Hash(oldSlot.corner) & mask;
+					while (m_Slots[slot].index != EMPTY_SLOT)
+						slot = (slot + 1) & mask;
+					m_Slots[slot] = oldSlot;
+				}
+			}
+
+		private:
+			static constexpr GLuint EMPTY_SLOT = std::numeric_limits<GLuint>::max();
+
+			std::vector<Slot> m_Slots;
+			size_t m_Count;
+		};
+
+		inline bool IsBlank(const char c) noexcept
+		{
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		inline const char* SkipBlanks(const char* p, const char* end) noexcept
+		{
+			while (p < end && IsBlank(*p))
+				p++;
+			return p;
+		}
+
+		// Parses a float, leaving value untouched when the text is not a number (matching istream extraction into a zeroed value)
+		inline const char* ParseFloat(const char* p, const char* end, float& value) noexcept
+		{
+			p = SkipBlanks(p, end);
+			if (p < end && *p == '+')
+				p++;
+			return std::from_chars(p, end, value).ptr;
+		}
+
+		std::string MakeToken(const char* begin, const char* end)
+		{
+			return std::string(begin, end - begin);
+		}
+
+		// Parses one index of a face corner, storing negative indices relative to the start of the chunk
+		inline const char* ParseCornerIndex(const char* p, const char* end, const char* tokenBegin, const size_t localCount, int& index, uint8_t& relativeMask, const uint8_t relativeBit)
+		{
+			int value = 0;
+			const auto result = std::from_chars(p, end, value);
+			if (result.ec != std::errc() || value == 0)
+			{
+				CAMEL_LOG_ERROR("Malformed obj face vertex '{}'", MakeToken(tokenBegin, end));
+				throw std::runtime_error("Malformed obj face vertex '" + MakeToken(tokenBegin, end) + "'");
+			}
+
+			if (value > 0)
+			{
+				index = value - 1;
+			}
+			else
+			{
+				index = (int)localCount + value;
+				relativeMask |= relativeBit;
+			}
+
+			return result.ptr;
+		}
+
+		// Parses a face corner in any of the forms v, v/vt, v//vn or v/vt/vn
+		ObjRawCorner ParseCorner(const char* begin, const char* end, const ObjChunk& chunk)
+		{
+			ObjRawCorner corner = { MISSING_INDEX, MISSING_INDEX, MISSING_INDEX, 0 };
+
+			const char* p = ParseCornerIndex(begin, end, begin, chunk.positions.size(), corner.position, corner.relativeMask, RELATIVE_POSITION);
+
+			if (p < end && *p == '/')
+			{
+				p++;
+				if (p < end && *p != '/')
+					p = ParseCornerIndex(p, end, begin, chunk.texCoords.size(), corner.texCoord, corner.relativeMask, RELATIVE_TEXCOORD);
+
+				if (p < end && *p == '/')
+				{
+					p++;
+					if (p < end)
+						p = ParseCornerIndex(p, end, begin, chunk.normals.size(), corner.normal, corner.relativeMask, RELATIVE_NORMAL);
+				}
+			}
+
+			if (p != end)
+			{
+				CAMEL_LOG_ERROR("Malformed obj face vertex '{}'", MakeToken(begin, end));
+				throw std::runtime_error("Malformed obj face vertex '" + MakeToken(begin, end) + "'");
+			}
+
+			return corner;
+		}
+
+		void ParseChunk(const char* p, const char* end, ObjChunk& chunk)
+		{
+			while (p < end)
+			{
+				const char* lineEnd = (const char*)std::memchr(p, '\n', end - p);
+				if (!lineEnd)
+					lineEnd = end;
+
+				p = SkipBlanks(p, lineEnd);
+
+				const char* keywordEnd = p;
+				while (keywordEnd < lineEnd && !IsBlank(*keywordEnd))
+					keywordEnd++;
+
+				const size_t keywordLength = keywordEnd - p;
+
+				if (keywordLength == 1 && p[0] == 'v')
+				{
+					glm::vec3 position{};
+					const char* q = ParseFloat(keywordEnd, lineEnd, position.x);
+					q = ParseFloat(q, lineEnd, position.y);
+					ParseFloat(q, lineEnd, position.z);
+					chunk.positions.push_back(position);
+				}
+				else if (keywordLength == 2 && p[0] == 'v' && p[1] == 'n')
+				{
+					glm::vec3 normal{};
+					const char* q = ParseFloat(keywordEnd, lineEnd, normal.x);
+					q = ParseFloat(q, lineEnd, normal.y);
+					ParseFloat(q, lineEnd, normal.z);
+					chunk.normals.push_back(normal);
+				}
+				else if (keywordLength == 2 && p[0] == 'v' && p[1] == 't')
+				{
+					glm::vec2 texCoord{};
+					const char* q = ParseFloat(keywordEnd, lineEnd, texCoord.x);
+					ParseFloat(q, lineEnd, texCoord.y);
+					chunk.texCoords.push_back(texCoord);
+				}
+				else if (keywordLength == 1 && p[0] == 'f')
+				{
+					uint32_t faceSize = 0;
+					const char* q = keywordEnd;
+					while (true)
+					{
+						q = SkipBlanks(q, lineEnd);
+						if (q >= lineEnd)
+							break;
+
+						const char* tokenEnd = q;
+						while (tokenEnd < lineEnd && !IsBlank(*tokenEnd))
+							tokenEnd++;
+
+						chunk.corners.push_back(ParseCorner(q, tokenEnd, chunk));
+						faceSize++;
+						q = tokenEnd;
+					}
+					chunk.faceSizes.push_back(faceSize);
+				}
+
+				p = lineEnd < end ? lineEnd + 1 : end;
+			}
+		}
+
+		// Resolves a raw index into the merged attribute stream, -1 when the attribute is absent. False when out of range
+		inline bool ResolveIndex(const int index, const bool isRelative, const size_t chunkOffset, const size_t count, int& resolved) noexcept
+		{
+			if (index == MISSING_INDEX)
+			{
+				resolved = -1;
+				return true;
+			}
+
+			const long long value = isRelative ? (long long)chunkOffset + index : (long long)index;
+			if (value < 0 || value >= (long long)count)
+				return false;
+
+			resolved = (int)value;
+			return true;
+		}
+
+		// Error path only. Finds the face corner in the text again, relative indices cannot be told apart once resolved,
+		// and reports the index as written along with its line. attribute is 0 for v, 1 for vt and 2 for vn
+		[[noreturn]] void ThrowIndexOutOfRange(const char* data, const ObjChunk& chunk, const size_t cornerIndex, const size_t attribute, const size_t count)
+		{
+			size_t face = 0, faceCorner = cornerIndex;
+			while (faceCorner >= chunk.faceSizes[face])
+				faceCorner -= chunk.faceSizes[face++];
+
+			size_t line = 1 + (size_t)std::count(data, chunk.begin, '\n');
+			std::string written;
+
+			size_t faceIndex = 0;
+			for (const char* p = chunk.begin; p < chunk.end; line++)
+			{
+				const char* lineEnd = (const char*)std::memchr(p, '\n', chunk.end - p);
+				if (!lineEnd)
+					lineEnd = chunk.end;
+
+				const char* q = SkipBlanks(p, lineEnd);
+				if (q < lineEnd && q[0] == 'f' && (q + 1 == lineEnd || IsBlank(q[1])) && faceIndex++ == face)
+				{
+					// The corner's token, then its attribute'th slash separated field
+					q++;
+					for (size_t i = 0; i <= faceCorner; i++)
+					{
+						q = SkipBlanks(q, lineEnd);
+						const char* tokenEnd = q;
+						while (tokenEnd < lineEnd && !IsBlank(*tokenEnd))
+							tokenEnd++;
+
+						if (i == faceCorner)
+						{
+							for (size_t field = 0; field < attribute && q < tokenEnd; field++)
+							{
+								q = (const char*)std::memchr(q, '/', tokenEnd - q);
+								q = q ? q + 1 : tokenEnd;
+							}
+							const char* fieldEnd = (const char*)std::memchr(q, '/', tokenEnd - q);
+							written = MakeToken(q, fieldEnd ? fieldEnd : tokenEnd);
+						}
+						q = tokenEnd;
+					}
+					break;
+				}
+
+				p = lineEnd + 1;
+			}
+
+			CAMEL_LOG_ERROR("Obj face index {} on line {} is out of range (count = {})", written, line, count);
+			throw std::runtime_error("Obj face index " + written + " on line " + std::to_string(line) + " is out of range");
+		}
+	}
+
+	MeshData ObjParser::ParseFile(const std::string& filePath, unsigned int threadCount, ObjParseTimings* timings, JobSystem* jobSystem)
+	{
+		MappedFile file(filePath);
+		return Parse(file.GetData(), file.GetSize(), filePath, threadCount, timings, jobSystem);
+	}
+
+	MeshData ObjParser::Parse(const char* data, size_t size, const std::string& name, unsigned int threadCount, ObjParseTimings* timings, JobSystem* jobSystem)
+	{
+		const auto parseStart = std::chrono::steady_clock::now();
+
+		if (threadCount == 0)
+			threadCount = jobSystem ? (unsigned int)jobSystem->GetWorkerCount() + 1 : std::max(1u, std::thread::hardware_concurrency());
+
+		// Split into line aligned chunks, each parsed independently
+		const size_t chunkCount = std::clamp<size_t>(size / MIN_CHUNK_SIZE, 1, threadCount);
+		std::vector<ObjChunk> chunks(chunkCount);
+
+		const char* end = data + size;
+		const char* chunkBegin = data;
+		for (size_t i = 0; i < chunkCount; i++)
+		{
+			const char* chunkEnd = i + 1 == chunkCount ? end : std::max(chunkBegin, data + size * (i + 1) / chunkCount);
+			if (chunkEnd < end)
+			{
+				const char* newline = (const char*)std::memchr(chunkEnd, '\n', end - chunkEnd);
+				chunkEnd = newline ? newline + 1 : end;
+			}
+
+			chunks[i].begin = chunkBegin;
+			chunks[i].end = chunkEnd;
+			chunkBegin = chunkEnd;
+		}
+
+		ForEachChunk(chunks, jobSystem, [](ObjChunk& chunk)
+		{
+			ParseChunk(chunk.begin, chunk.end, chunk);
+		});
+
+		// Merge attribute streams, remembering where each chunk starts for relative indices
+		std::vector<glm::vec3> positions, normals;
+		std::vector<glm::vec2> texCoords;
+		size_t cornerCount = 0, indexCount = 0;
+
+		for (ObjChunk& chunk : chunks)
+		{
+			chunk.positionOffset = positions.size();
+			chunk.texCoordOffset = texCoords.size();
+			chunk.normalOffset = normals.size();
+			chunk.indexOffset = indexCount;
+
+			positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+			texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+			normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+
+			cornerCount += chunk.corners.size();
+			for (const uint32_t faceSize : chunk.faceSizes)
+				indexCount += faceSize >= 3 ? (faceSize - 2) * 3 : 0;
+		}
+
+		ForEachChunk(chunks, jobSystem, [&](ObjChunk& chunk)
+		{
+			chunk.resolvedCorners.resize(chunk.corners.size());
+			for (size_t i = 0; i < chunk.corners.size(); i++)
+			{
+				const ObjRawCorner& raw = chunk.corners[i];
+				ObjCorner& corner = chunk.resolvedCorners[i];
+				if (!ResolveIndex(raw.position, raw.relativeMask & RELATIVE_POSITION, chunk.positionOffset, positions.size(), corner.position))
+					ThrowIndexOutOfRange(data, chunk, i, 0, positions.size());
+				if (!ResolveIndex(raw.texCoord, raw.relativeMask & RELATIVE_TEXCOORD, chunk.texCoordOffset, texCoords.size(), corner.texCoord))
+					ThrowIndexOutOfRange(data, chunk, i, 1, texCoords.size());
+				if (!ResolveIndex(raw.normal, raw.relativeMask & RELATIVE_NORMAL, chunk.normalOffset, normals.size(), corner.normal))
+					ThrowIndexOutOfRange(data, chunk, i, 2, normals.size());
+			}
+			chunk.corners = {};
+		});
+
+		const auto deduplicateStart = std::chrono::steady_clock::now();
+
+		// Deduplication is the only serial step, it assigns vertex indices in order of first use
+		ObjCornerMap uniqueVertices(cornerCount / 4);
+		std::vector<ObjCorner> uniqueCorners;
+		uniqueCorners.reserve(cornerCount / 4);
+
+		for (ObjChunk& chunk : chunks)
+		{
+			chunk.cornerVertices.resize(chunk.resolvedCorners.size());
+			for (size_t i = 0; i < chunk.resolvedCorners.size(); i++)
+			{
+				bool inserted;
+				chunk.cornerVertices[i] = uniqueVertices.FindOrInsert(chunk.resolvedCorners[i], inserted);
+				if (inserted)
+					uniqueCorners.push_back(chunk.resolvedCorners[i]);
+			}
+			chunk.resolvedCorners = {};
+		}
+
+		MeshData mesh;
+		mesh.vertices.resize(uniqueCorners.size());
+		mesh.indices.resize(indexCount);
+
+		// Gather vertex attributes, each chunk also writes a slice of the unique vertices
+		const size_t verticesPerChunk = (uniqueCorners.size() + chunkCount - 1) / chunkCount;
+		ForEachChunk(chunks, jobSystem, [&](ObjChunk& chunk)
+		{
+			const size_t chunkIndex = &chunk - chunks.data();
+			const size_t first = std::min(chunkIndex * verticesPerChunk, uniqueCorners.size());
+			const size_t last = std::min(first + verticesPerChunk, uniqueCorners.size());
+
+			for (size_t i = first; i < last; i++)
+			{
+				const ObjCorner& corner = uniqueCorners[i];
+				Vertex& vertex = mesh.vertices[i];
+				vertex.position = positions[corner.position];
+				vertex.normal = corner.normal != -1 ? normals[corner.normal] : glm::vec3(0.0f);
+				vertex.texcoord = corner.texCoord != -1 ? texCoords[corner.texCoord] : glm::vec2(0.0f);
+				chunk.hasMissingAttributes |= corner.normal == -1 || corner.texCoord == -1;
+			}
+
+			// Fan triangulate quads and n-gons, keeping the face winding
+			GLuint* index = mesh.indices.data() + chunk.indexOffset;
+			const GLuint* faceVertices = chunk.cornerVertices.data();
+			for (const uint32_t faceSize : chunk.faceSizes)
+			{
+				if (faceSize < 3)
+				{
+					chunk.degenerateFaceCount++;
+				}
+				else
+				{
+					for (uint32_t i = 1; i + 1 < faceSize; i++)
+					{
+						*index++ = faceVertices[0];
+						*index++ = faceVertices[i];
+						*index++ = faceVertices[i + 1];
+					}
+				}
+				faceVertices += faceSize;
+			}
+		});
+
+		if (timings)
+		{
+			const auto deduplicateEnd = std::chrono::steady_clock::now();
+			timings->parseSeconds = std::chrono::duration<double>(deduplicateStart - parseStart).count();
+			timings->deduplicateSeconds = std::chrono::duration<double>(deduplicateEnd - deduplicateStart).count();
+		}
+
+		size_t degenerateFaceCount = 0;
+		bool hasMissingAttributes = false;
+		for (const ObjChunk& chunk : chunks)
+		{
+			degenerateFaceCount += chunk.degenerateFaceCount;
+			hasMissingAttributes |= chunk.hasMissingAttributes;
+		}
+
+		if (degenerateFaceCount > 0)
+			CAMEL_LOG_WARN("Skipped {} degenerate faces with less than 3 vertices in {}", degenerateFaceCount, name);
+
+		if (hasMissingAttributes)
+			CAMEL_LOG_WARN("Mesh {} has faces without texcoords or normals, defaulting them to zero", name);
+
+		// Without deduplication every triangle corner would be its own vertex
+		CAMEL_LOG_INFO("Loaded mesh {}: {} vertices ({} before deduplication), {} triangles", name, mesh.vertices.size(), mesh.indices.size(), mesh.indices.size() / 3);
+
+		return mesh;
+	}
+}
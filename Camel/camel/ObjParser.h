@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Core.h"
+#include "Mesh.h"
+
+namespace Camel
+{
+	class JobSystem;
+
+	// Wall clock time spent in each stage of a parse
+	struct ObjParseTimings
+	{
+		double parseSeconds; // Tokenizing chunks and merging attribute streams
+		double deduplicateSeconds; // Vertex deduplication, attribute gathering and triangulation
+	};
+
+	// Parses wavefront obj files into deduplicated, triangulated geometry.
+	// The file is memory mapped and split into line-aligned chunks that are parsed in parallel, then merged.
+	// Chunks run as jobs when given a job system, otherwise on threads of their own
+	class ObjParser final
+	{
+	public:
+		static MeshData ParseFile(const std::string& filePath, unsigned int threadCount = 0, ObjParseTimings* timings = nullptr, JobSystem* jobSystem = nullptr);
+		static MeshData Parse(const char* data, size_t size, const std::string& name, unsigned int threadCount = 0, ObjParseTimings* timings = nullptr, JobSystem* jobSystem = nullptr);
+
+	public:
+		ObjParser() = delete;
+	};
+}
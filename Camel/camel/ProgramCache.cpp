@@ -0,0 +1,167 @@
+#include "ProgramCache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace Camel
+{
+	namespace
+	{
+		std::string& GetDirectoryStorage()
+		{
+			static std::string directory;
+			return directory;
+		}
+
+		// 64-bit FNV-1a, continued from hash
+		uint64_t HashBytes(uint64_t hash, const char* data, const size_t size) noexcept
+		{
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= (uint8_t)data[i];
+				hash *= 0x100000001B3ull;
+			}
+			return hash;
+		}
+
+		uint64_t HashString(const uint64_t hash, const char* string) noexcept
+		{
+			// Includes the terminator so consecutive strings cannot run into each other
+			return HashBytes(hash, string, std::char_traits<char>::length(string) + 1);
+		}
+
+		uint64_t HashGLString(const uint64_t hash, const GLenum name) noexcept
+		{
+			const GLubyte* value = glGetString(name);
+			return HashString(hash, value ? reinterpret_cast<const char*>(value) : "");
+		}
+
+		std::filesystem::path GetCachePath(const uint64_t key)
+		{
+			return std::filesystem::path(GetDirectoryStorage()) / std::format("{:016x}{}", key, ProgramCache::EXTENSION);
+		}
+	}
+
+	void ProgramCache::SetDirectory(const std::string& directory)
+	{
+		GetDirectoryStorage() = directory;
+	}
+
+	const std::string& ProgramCache::GetDirectory() noexcept
+	{
+		return GetDirectoryStorage();
+	}
+
+	bool ProgramCache::IsEnabled()
+	{
+		if (GetDirectoryStorage().empty() || !GLEW_ARB_get_program_binary)
+			return false;
+
+		GLint formatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+		return formatCount > 0;
+	}
+
+	uint64_t ProgramCache::ComputeKey(const std::string& vertexSource, const std::string& fragmentSource)
+	{
+		uint64_t hash = 0xCBF29CE484222325ull;
+		hash = HashGLString(hash, GL_VENDOR);
+		hash = HashGLString(hash, GL_RENDERER);
+		hash = HashGLString(hash, GL_VERSION);
+		hash = HashString(hash, vertexSource.c_str());
+		hash = HashString(hash, fragmentSource.c_str());
+		return hash;
+	}
+
+	bool ProgramCache::Load(const GLuint program, const uint64_t key)
+	{
+		const std::filesystem::path path = GetCachePath(key);
+
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return false;
+
+		std::error_code error;
+		const uintmax_t fileSize = std::filesystem::file_size(path, error);
+
+		ProgramCacheHeader header{};
+		std::vector<char> binary;
+		bool isValid = !error && file.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.magic == MAGIC && header.version == VERSION &&
+			header.key == key && header.size > 0 && sizeof(header) + header.size == fileSize;
+		if (isValid)
+		{
+			binary.resize(header.size);
+			isValid = (bool)file.read(binary.data(), binary.size());
+		}
+		file.close();
+
+		GLint success = GL_FALSE;
+		if (isValid)
+		{
+			glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+			glGetProgramiv(program, GL_LINK_STATUS, &success);
+		}
+
+		// Driver updates invalidate binaries without changing the version string on some platforms
+		if (!success)
+		{
+			CAMEL_LOG_INFO("Discarding program binary at path: {}", path.string());
+			std::filesystem::remove(path, error);
+			return false;
+		}
+
+		return true;
+	}
+
+	void ProgramCache::Store(const GLuint program, const uint64_t key)
+	{
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+		{
+			CAMEL_LOG_WARN("Driver returned no binary for program {}", program);
+			return;
+		}
+
+		ProgramCacheHeader header{};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.key = key;
+
+		std::vector<char> binary(length);
+		GLenum format = 0;
+		glGetProgramBinary(program, length, &length, &format, binary.data());
+		header.format = format;
+		header.size = (uint32_t)length;
+
+		const std::filesystem::path path = GetCachePath(key);
+		std::error_code error;
+		std::filesystem::create_directories(path.parent_path(), error);
+
+		// Written aside and renamed so a crash or a second instance never leaves a partial file under the real name
+		std::filesystem::path temporaryPath = path;
+		temporaryPath += ".tmp";
+		bool isWritten;
+		{
+			std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(binary.data(), header.size);
+			isWritten = (bool)file;
+		}
+
+		if (!isWritten)
+		{
+			CAMEL_LOG_WARN("Failed to write program binary at path: {}", temporaryPath.string());
+			std::filesystem::remove(temporaryPath, error);
+			return;
+		}
+
+		std::filesystem::rename(temporaryPath, path, error);
+		if (error)
+		{
+			CAMEL_LOG_WARN("Failed to store program binary at path: {}", path.string());
+			std::filesystem::remove(temporaryPath, error);
+		}
+	}
+}
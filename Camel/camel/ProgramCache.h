@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Core.h"
+
+namespace Camel
+{
+	struct ProgramCacheHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t key;
+		uint32_t format; // Driver specific binary format from glGetProgramBinary
+		uint32_t size;
+	};
+
+	// On-disk cache of linked program binaries (.cprog), one file per program named after its key. Binaries only
+	// load on the driver that wrote them, so the key covers the GL vendor, renderer and version besides the sources
+	class ProgramCache final
+	{
+	public:
+		static constexpr uint32_t MAGIC = 0x47525043; // "CPRG"
+		static constexpr uint32_t VERSION = 1;
+		static constexpr const char* EXTENSION = ".cprog";
+
+		// An empty directory, the default, disables the cache
+		static void SetDirectory(const std::string& directory);
+		static const std::string& GetDirectory() noexcept;
+
+		// Whether a directory is set and the driver supports at least one binary format
+		static bool IsEnabled();
+
+		// Needs a current GL context for the driver strings
+		static uint64_t ComputeKey(const std::string& vertexSource, const std::string& fragmentSource);
+
+		// Loads the binary stored under key into program. False when there is none or the driver rejects it,
+		// rejected files are deleted and the program is left unusable
+		static bool Load(const GLuint program, const uint64_t key);
+
+		// Writes the binary of a linked program, failures are only logged since the cache is optional
+		static void Store(const GLuint program, const uint64_t key);
+
+	public:
+		ProgramCache() = delete;
+	};
+}
@@ -0,0 +1,232 @@
+#include "Renderer.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace Camel
+{
+	namespace
+	{
+		// Key layout from the most significant bit. Solid: pass 2, shader 14, texture 14, mesh 14, depth 20.
+		// Translucent: pass 2, inverted depth 20, shader 14, texture 14, mesh 14
+		constexpr uint64_t ID_BITS = 14;
+		constexpr uint64_t ID_MASK = (1ull << ID_BITS) - 1;
+		constexpr uint64_t DEPTH_BITS = 20;
+		constexpr uint64_t DEPTH_MASK = (1ull << DEPTH_BITS) - 1;
+		constexpr uint64_t PASS_SHIFT = 62;
+
+		// The bits of a non-negative float sort like the float, the top 20 below the sign keep the exponent and some mantissa
+		inline uint64_t QuantizeDepth(const float distance) noexcept
+		{
+			return (uint64_t)(std::bit_cast<uint32_t>(std::max(distance, 0.0f)) >> (31 - DEPTH_BITS)) & DEPTH_MASK;
+		}
+
+		const Uniform<GLint> DIFFUSE_IMAGE_UNIFORM("u_DiffuseImage");
+		const Uniform<glm::vec3> BASE_COLOR_UNIFORM("u_BaseColor");
+		const Uniform<glm::mat4> MODEL_UNIFORM("u_Model");
+		const Uniform<glm::mat3> NORMAL_MATRIX_UNIFORM("u_NormalMatrix");
+		const Uniform<glm::mat4> DEQUANTIZE_UNIFORM("u_Dequantize");
+
+		inline bool IsArenaBatchable(const DrawPacket& packet) noexcept
+		{
+			return packet.mesh->GetArena() && packet.shader->ReadsInstanceData();
+		}
+	}
+
+	Renderer::Renderer()
+		: m_CameraBuffer(sizeof(CameraBlock), CAMERA_BLOCK_BINDING), m_LightsBuffer(sizeof(LightsBlock), LIGHTS_BLOCK_BINDING)
+	{
+	}
+
+	void Renderer::BeginFrame(const FrameUniforms& frame)
+	{
+		m_StateStatsAtBegin = GLState::GetStats();
+		m_Frame = frame;
+		m_ViewProjection = frame.projection * frame.view;
+
+		CameraBlock camera;
+		camera.view = frame.view;
+		camera.projection = frame.projection;
+		camera.viewProjection = m_ViewProjection;
+		camera.position = frame.cameraPosition;
+		m_CameraBuffer.Update(camera);
+
+		LightsBlock lights;
+		lights.position = frame.lightPosition;
+		lights.color = frame.lightColor;
+		lights.skyColor = frame.skyColor;
+		lights.groundColor = frame.groundColor;
+		m_LightsBuffer.Update(lights);
+
+		// Bound every frame in case other code used the binding points in between
+		m_CameraBuffer.Bind();
+		m_LightsBuffer.Bind();
+
+		m_Packets.clear();
+		m_Keys.clear();
+		m_ShaderIDs.clear();
+		m_TextureIDs.clear();
+		m_MeshIDs.clear();
+		m_Stats = {};
+	}
+
+	void Renderer::Submit(const DrawPacket& submitted)
+	{
+		CAMEL_ASSERT(submitted.mesh && submitted.shader, "Draw packets need a mesh and a shader");
+
+		DrawPacket packet = submitted;
+		if (!packet.shader->IsReady())
+		{
+			m_Stats.pendingDraws++;
+			if (!m_FallbackShader || !m_FallbackShader->IsReady())
+				return;
+			packet.shader = m_FallbackShader;
+		}
+
+		const uint64_t shader = GetSortID(m_ShaderIDs, packet.shader) & ID_MASK;
+		const uint64_t texture = (packet.texture ? GetSortID(m_TextureIDs, packet.texture) : 0) & ID_MASK;
+		const uint64_t mesh = GetSortID(m_MeshIDs, packet.mesh) & ID_MASK;
+		const uint64_t depth = QuantizeDepth(glm::length(glm::vec3(packet.model[3]) - m_Frame.cameraPosition));
+
+		uint64_t key = (uint64_t)packet.pass << PASS_SHIFT;
+		if (packet.pass == RenderPass::TRANSLUCENT)
+			key |= ((DEPTH_MASK - depth) << (3 * ID_BITS)) | (shader << (2 * ID_BITS)) | (texture << ID_BITS) | mesh;
+		else
+			key |= (shader << (2 * ID_BITS + DEPTH_BITS)) | (texture << (ID_BITS + DEPTH_BITS)) | (mesh << DEPTH_BITS) | depth;
+
+		m_Keys.emplace_back(key, (uint32_t)m_Packets.size());
+		m_Packets.push_back(packet);
+	}
+
+	void Renderer::EndFrame()
+	{
+		std::sort(m_Keys.begin(), m_Keys.end());
+
+		const Shader* boundShader = nullptr;
+		const Texture* boundTexture = nullptr;
+		const Mesh* boundMesh = nullptr;
+		bool isTranslucent = false;
+
+		for (size_t i = 0; i < m_Keys.size();)
+		{
+			const DrawPacket& packet = m_Packets[m_Keys[i].second];
+
+			// Blended geometry is depth tested against the solid pass but does not occlude itself
+			if (packet.pass == RenderPass::TRANSLUCENT && !isTranslucent)
+			{
+				GLState::SetDepthMask(false);
+				isTranslucent = true;
+			}
+
+			if (packet.shader != boundShader)
+			{
+				packet.shader->Bind();
+				SetFrameUniforms(*packet.shader);
+				boundShader = packet.shader;
+				m_Stats.shaderChanges++;
+			}
+
+			if (packet.texture && packet.texture != boundTexture)
+			{
+				packet.texture->Bind();
+				boundTexture = packet.texture;
+				m_Stats.textureChanges++;
+			}
+
+			if (IsArenaBatchable(packet))
+			{
+				// The arena binds its own vertex array
+				boundMesh = nullptr;
+				m_Stats.meshChanges++;
+				i = DrawArenaBatch(i);
+				continue;
+			}
+
+			if (packet.mesh != boundMesh)
+			{
+				packet.mesh->Bind();
+				boundMesh = packet.mesh;
+				m_Stats.meshChanges++;
+			}
+
+			GLsizei indexCount;
+			if (packet.shader->ReadsInstanceData())
+			{
+				// The shader takes the model matrix and color from the instance attributes, which only an instanced draw sets up
+				packet.shader->SetUniform(DEQUANTIZE_UNIFORM, packet.mesh->GetDequantizeMatrix());
+				m_DrawData.assign(1, InstanceData{ packet.model, glm::vec4(packet.baseColor, 1.0f) });
+				m_DrawDataBuffer.SetInstances(m_DrawData);
+				packet.mesh->DrawInstanced(m_DrawDataBuffer, packet.lod, 0, 1);
+				indexCount = packet.mesh->GetLods()[packet.lod].indexCount;
+			}
+			else
+			{
+				packet.shader->SetUniform(BASE_COLOR_UNIFORM, packet.baseColor);
+				packet.shader->SetUniform(MODEL_UNIFORM, packet.model * packet.mesh->GetDequantizeMatrix());
+				packet.shader->SetUniform(NORMAL_MATRIX_UNIFORM, glm::transpose(glm::inverse(glm::mat3(packet.model))));
+
+				indexCount = packet.lod == 0
+					? packet.mesh->DrawClustersBound(packet.model, m_ViewProjection, m_Frame.cameraPosition)
+					: packet.mesh->DrawBound(packet.lod);
+			}
+			m_Stats.drawCalls++;
+			m_Stats.triangles += indexCount / 3;
+			i++;
+		}
+
+		if (isTranslucent)
+			GLState::SetDepthMask(true);
+
+		const GLStateStats& stateStats = GLState::GetStats();
+		m_Stats.stateChanges = stateStats.issued - m_StateStatsAtBegin.issued;
+		m_Stats.redundantStateChanges = stateStats.skipped - m_StateStatsAtBegin.skipped;
+	}
+
+	size_t Renderer::DrawArenaBatch(const size_t first)
+	{
+		const DrawPacket& firstPacket = m_Packets[m_Keys[first].second];
+		GeometryArena& arena = *firstPacket.mesh->GetArena();
+		const glm::mat4& dequantize = firstPacket.mesh->GetDequantizeMatrix();
+
+		m_ArenaCommands.clear();
+		m_DrawData.clear();
+
+		// Instance matrices do not dequantize (normals would skew), so a run also needs the same dequantize matrix.
+		// Every mesh of the standard layout has the identity
+		size_t end = first;
+		for (; end < m_Keys.size(); end++)
+		{
+			const DrawPacket& packet = m_Packets[m_Keys[end].second];
+			if (packet.shader != firstPacket.shader || packet.texture != firstPacket.texture || packet.pass != firstPacket.pass ||
+				packet.mesh->GetArena() != &arena || packet.mesh->GetDequantizeMatrix() != dequantize)
+				break;
+
+			const GLsizei indexCount = packet.mesh->AppendArenaCommands(m_ArenaCommands, packet.lod, packet.model, m_ViewProjection, m_Frame.cameraPosition);
+			m_DrawData.resize(m_ArenaCommands.size(), InstanceData{ packet.model, glm::vec4(packet.baseColor, 1.0f) });
+			m_Stats.triangles += indexCount / 3;
+		}
+
+		if (!m_ArenaCommands.empty())
+		{
+			firstPacket.shader->SetUniform(DEQUANTIZE_UNIFORM, dequantize);
+			m_DrawDataBuffer.SetInstances(m_DrawData);
+			arena.MultiDraw(m_ArenaCommands, &m_DrawDataBuffer);
+
+			m_Stats.drawCalls += arena.HasIndirectDraw() ? 1 : m_ArenaCommands.size();
+			m_Stats.arenaBatches++;
+		}
+		return end;
+	}
+
+	uint64_t Renderer::GetSortID(std::unordered_map<const void*, uint64_t>& ids, const void* resource)
+	{
+		// 0 is left for "none"
+		return ids.try_emplace(resource, ids.size() + 1).first->second;
+	}
+
+	void Renderer::SetFrameUniforms(Shader& shader) const
+	{
+		// Camera and lighting come from the uniform blocks
+		shader.SetUniform(DIFFUSE_IMAGE_UNIFORM, 0);
+	}
+}
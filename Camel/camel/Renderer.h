@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Core.h"
+#include "GeometryArena.h"
+#include "GLState.h"
+#include "InstanceBuffer.h"
+#include "Mesh.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace Camel
+{
+	// Passes draw in order. Solid packets are sorted by state then front to back, translucent ones back to front
+	enum class RenderPass : uint8_t
+	{
+		SOLID,
+		TRANSLUCENT,
+	};
+
+	// Everything needed to issue one draw
+	struct DrawPacket
+	{
+		const Mesh* mesh = nullptr;
+		Shader* shader = nullptr;
+		const Texture* texture = nullptr; // Optional, bound to slot 0
+		glm::mat4 model = glm::mat4(1.0f);
+		glm::vec3 baseColor = glm::vec3(1.0f);
+		size_t lod = 0; // The finest level draws through DrawClusters
+		RenderPass pass = RenderPass::SOLID;
+	};
+
+	// Data shared by every draw of a frame, uploaded once into the Camera and Lights uniform blocks
+	struct FrameUniforms
+	{
+		glm::mat4 view = glm::mat4(1.0f);
+		glm::mat4 projection = glm::mat4(1.0f);
+		glm::vec3 cameraPosition = glm::vec3(0.0f);
+		glm::vec3 lightPosition = glm::vec3(0.0f);
+		glm::vec3 lightColor = glm::vec3(0.0f);
+		glm::vec3 skyColor = glm::vec3(0.0f);
+		glm::vec3 groundColor = glm::vec3(0.0f);
+	};
+
+	struct RenderStats
+	{
+		size_t drawCalls = 0;
+		size_t shaderChanges = 0;
+		size_t textureChanges = 0;
+		size_t meshChanges = 0;
+		size_t triangles = 0;
+		size_t arenaBatches = 0; // Runs of arena meshes drawn with one GeometryArena::MultiDraw
+		size_t pendingDraws = 0; // Submitted with a shader that was still compiling, drawn with the fallback or dropped
+		size_t stateChanges = 0; // GL state changes GLState passed to the driver between BeginFrame and EndFrame
+		size_t redundantStateChanges = 0; // Ones it filtered out
+	};
+
+	// Collects the draws of a frame and submits them sorted by a 64-bit key, so that draws sharing a shader,
+	// texture and mesh run back to back and each state is bound once per run. Consecutive draws of meshes in the same
+	// GeometryArena with a shader that reads InstanceData go out as one GeometryArena::MultiDraw, their model matrix and
+	// base color passed per draw. Such shaders draw meshes outside an arena as a single instance.
+	class Renderer final
+	{
+	public:
+		Renderer();
+
+		Renderer(const Renderer&) = delete;
+		Renderer& operator=(const Renderer&) = delete;
+
+		~Renderer() = default;
+
+		// Drops the packets and statistics of the previous frame and uploads the frame's uniform blocks
+		void BeginFrame(const FrameUniforms& frame);
+		void Submit(const DrawPacket& packet);
+
+		// Stands in for shaders that are still compiling. Without one their draws are dropped until they are ready
+		inline void SetFallbackShader(Shader* shader) noexcept { m_FallbackShader = shader; }
+
+		// Sorts and draws everything submitted since BeginFrame
+		void EndFrame();
+
+		inline const RenderStats& GetStats() const noexcept { return m_Stats; }
+		inline size_t GetPacketCount() const noexcept { return m_Packets.size(); }
+
+	private:
+		// Small per-frame ids keep the key fields narrow, GL names can grow past the bits available
+		static uint64_t GetSortID(std::unordered_map<const void*, uint64_t>& ids, const void* resource);
+
+		void SetFrameUniforms(Shader& shader) const;
+
+		// Draws the run of arena packets starting at m_Keys[first] and returns the index of the key after it
+		size_t DrawArenaBatch(const size_t first);
+
+	private:
+		FrameUniforms m_Frame;
+		glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+
+		UniformBuffer m_CameraBuffer;
+		UniformBuffer m_LightsBuffer;
+
+		std::vector<DrawPacket> m_Packets;
+		std::vector<std::pair<uint64_t, uint32_t>> m_Keys; // Sort key and packet index
+
+		std::unordered_map<const void*, uint64_t> m_ShaderIDs;
+		std::unordered_map<const void*, uint64_t> m_TextureIDs;
+		std::unordered_map<const void*, uint64_t> m_MeshIDs;
+
+		// Per-draw data of shaders that read InstanceData, arena command i reads element i
+		std::vector<ArenaDrawCommand> m_ArenaCommands;
+		std::vector<InstanceData> m_DrawData;
+		InstanceBuffer m_DrawDataBuffer;
+
+		RenderStats m_Stats;
+		GLStateStats m_StateStatsAtBegin;
+		Shader* m_FallbackShader = nullptr;
+	};
+}
@@ -0,0 +1,119 @@
+#include "Scene.h"
+#include "FrustumCuller.h"
+
+namespace Camel
+{
+	Scene::Scene()
+		: m_SkyColor(0.3f, 0.7f, 1.0f), m_GroundColor(0.5f, 0.4f, 0.3f)
+	{
+		m_Registry.on_destroy<MeshInstance>().connect<&Scene::OnMeshInstanceDestroyed>(this);
+	}
+
+	entt::entity Scene::CreateEntity(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+	{
+		const entt::entity entity = m_Registry.create();
+		m_Registry.emplace<Transform>(entity, position, rotation, scale);
+		return entity;
+	}
+
+	void Scene::DestroyEntity(const entt::entity entity)
+	{
+		m_Registry.destroy(entity);
+	}
+
+	void Scene::Update(JobSystem* jobSystem)
+	{
+		// Edits made after the engine's pass (in OnUpdate) would otherwise be recomposed through their ancestors on every read
+		TransformHierarchy::GetInstance().Update(jobSystem);
+
+		m_Registry.view<Transform, MeshInstance>().each([this](const entt::entity entity, const Transform& transform, MeshInstance& instance)
+		{
+			// Failed meshes never enter the spatial index, so they are never drawn
+			if (!instance.mesh.IsValid() || instance.mesh.GetStatus() == AssetStatus::LOADING || instance.mesh.ReportFailure("mesh"))
+				return;
+
+			instance.worldBounds = instance.mesh->GetBounds().Transformed(transform.GetLocalToWorldMatrix());
+			const Bounds& bounds = instance.worldBounds;
+			if (instance.spatialProxy == DynamicAabbTree::INVALID_PROXY)
+				instance.spatialProxy = m_SpatialIndex.Insert(bounds.min, bounds.max, entt::to_integral(entity));
+			else
+				m_SpatialIndex.Move(instance.spatialProxy, bounds.min, bounds.max);
+		});
+	}
+
+	void Scene::Render(Renderer& renderer, const Camera& camera, const float viewportHeight)
+	{
+		m_Visible.clear();
+		m_Candidates.clear();
+		m_CandidateCenters.clear();
+		m_CandidateExtents.clear();
+
+		const Frustum frustum = camera.GetFrustum();
+		m_SpatialIndex.QueryFrustum(frustum, [this](const uint32_t, const uint32_t userData)
+		{
+			m_Visible.push_back(static_cast<entt::entity>(userData));
+		},
+		[this](const uint32_t, const uint32_t userData)
+		{
+			const entt::entity entity = static_cast<entt::entity>(userData);
+			const Bounds& bounds = m_Registry.get<MeshInstance>(entity).worldBounds;
+			m_Candidates.push_back(entity);
+			m_CandidateCenters.push_back((bounds.min + bounds.max) * 0.5f);
+			m_CandidateExtents.push_back(bounds.GetExtents());
+		});
+
+		// The tree only tested the enlarged boxes, the ones crossing the frustum boundary are culled on their exact bounds in one batch
+		FrustumCuller::CullBoxes(frustum, m_CandidateCenters.data(), m_CandidateExtents.data(), m_Candidates.size(), m_VisibleCandidates);
+		for (const uint32_t index : m_VisibleCandidates)
+			m_Visible.push_back(m_Candidates[index]);
+
+		FrameUniforms frame;
+		frame.view = camera.GetViewMatrix();
+		frame.projection = camera.GetProjectionMatrix();
+		frame.cameraPosition = camera.GetTransform().GetWorldPosition();
+		frame.skyColor = m_SkyColor;
+		frame.groundColor = m_GroundColor;
+
+		auto lights = m_Registry.view<Transform, Light>();
+		if (lights.begin() != lights.end())
+		{
+			const entt::entity light = *lights.begin();
+			frame.lightPosition = m_Registry.get<Transform>(light).GetWorldPosition();
+			frame.lightColor = m_Registry.get<Light>(light).GetColor();
+		}
+
+		renderer.BeginFrame(frame);
+		m_LodSelector.SetView(camera, viewportHeight);
+
+		for (const entt::entity entity : m_Visible)
+		{
+			// Skip what cannot be drawn yet, and for good when one of its assets failed to load
+			const Material* material = m_Registry.try_get<Material>(entity);
+			if (!material || !material->shader.IsValid() || material->shader.GetStatus() == AssetStatus::LOADING || material->diffuse.GetStatus() == AssetStatus::LOADING)
+				continue;
+			if (material->shader.ReportFailure("shader") || material->diffuse.ReportFailure("texture"))
+				continue;
+
+			DrawPacket packet;
+			packet.mesh = &m_Registry.get<MeshInstance>(entity).mesh.Get();
+			packet.shader = &material->shader.Get();
+			packet.texture = material->diffuse.IsValid() ? &material->diffuse.Get() : nullptr;
+			packet.model = m_Registry.get<Transform>(entity).GetLocalToWorldMatrix();
+			packet.baseColor = material->baseColor;
+			packet.lod = m_LodSelector.Select(*packet.mesh, packet.model);
+			renderer.Submit(packet);
+		}
+
+		renderer.EndFrame();
+	}
+
+	void Scene::OnMeshInstanceDestroyed(entt::registry& registry, const entt::entity entity)
+	{
+		MeshInstance& instance = registry.get<MeshInstance>(entity);
+		if (instance.spatialProxy != DynamicAabbTree::INVALID_PROXY)
+		{
+			m_SpatialIndex.Remove(instance.spatialProxy);
+			instance.spatialProxy = DynamicAabbTree::INVALID_PROXY;
+		}
+	}
+}
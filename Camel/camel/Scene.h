@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Core.h"
+#include "Camera.h"
+#include "Components.h"
+#include "DynamicAabbTree.h"
+#include "Light.h"
+#include "LodSelector.h"
+#include "Renderer.h"
+#include "Transform.h"
+
+#include <entt/entt.hpp>
+#include <vector>
+
+namespace Camel
+{
+	// Entities and their components in packed EnTT storage. Every entity has a Transform, mesh instances
+	// are tracked in a spatial index so rendering only touches what the camera can see.
+	class Scene final
+	{
+	public:
+		Scene();
+
+		// The registry signals are bound to this instance
+		Scene(const Scene&) = delete;
+		Scene& operator=(const Scene&) = delete;
+		Scene(Scene&&) = delete;
+		Scene& operator=(Scene&&) = delete;
+
+		~Scene() = default;
+
+		entt::entity CreateEntity(const glm::vec3& position = glm::vec3(0.0f), const glm::quat& rotation = glm::quat(1, 0, 0, 0), const glm::vec3& scale = glm::vec3(1.0f));
+		void DestroyEntity(const entt::entity entity);
+
+		template<typename T, typename... Args>
+		inline T& AddComponent(const entt::entity entity, Args&&... args) { return m_Registry.emplace<T>(entity, std::forward<Args>(args)...); }
+
+		template<typename T>
+		inline T& GetComponent(const entt::entity entity) { return m_Registry.get<T>(entity); }
+
+		template<typename T>
+		inline T* TryGetComponent(const entt::entity entity) { return m_Registry.try_get<T>(entity); }
+
+		template<typename T>
+		inline bool HasComponent(const entt::entity entity) const { return m_Registry.all_of<T>(entity); }
+
+		template<typename T>
+		inline void RemoveComponent(const entt::entity entity) { m_Registry.remove<T>(entity); }
+
+		inline entt::registry& GetRegistry() noexcept { return m_Registry; }
+		inline const DynamicAabbTree& GetSpatialIndex() const noexcept { return m_SpatialIndex; }
+
+		// Propagates the frame's transform edits in one batched pass (over jobSystem when given), then moves the world bounds
+		// of mesh instances into the spatial index. Call after transforms changed for the frame, before Render
+		void Update(JobSystem* jobSystem = nullptr);
+
+		// Submits the visible mesh instances to the renderer as one frame, lit by the first Light in the scene
+		void Render(Renderer& renderer, const Camera& camera, const float viewportHeight);
+
+		inline size_t GetVisibleCount() const noexcept { return m_Visible.size(); }
+
+		inline const glm::vec3& GetSkyColor() const noexcept { return m_SkyColor; }
+		inline void SetSkyColor(const glm::vec3& color) noexcept { m_SkyColor = color; }
+
+		inline const glm::vec3& GetGroundColor() const noexcept { return m_GroundColor; }
+		inline void SetGroundColor(const glm::vec3& color) noexcept { m_GroundColor = color; }
+
+	private:
+		void OnMeshInstanceDestroyed(entt::registry& registry, const entt::entity entity);
+
+	private:
+		entt::registry m_Registry;
+		DynamicAabbTree m_SpatialIndex;
+		LodSelector m_LodSelector;
+		std::vector<entt::entity> m_Visible; // Reused every frame
+
+		// Instances whose fat box crosses a frustum plane, tested again on their exact bounds
+		std::vector<entt::entity> m_Candidates;
+		std::vector<glm::vec3> m_CandidateCenters;
+		std::vector<glm::vec3> m_CandidateExtents;
+		std::vector<uint32_t> m_VisibleCandidates;
+
+		glm::vec3 m_SkyColor;
+		glm::vec3 m_GroundColor;
+	};
+}
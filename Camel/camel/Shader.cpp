@@ -1,11 +1,61 @@
 #include "Shader.h"
+#include "ProgramCache.h"
+#include "UniformBuffer.h"
+#include "VertexLayout.h"
 
+#include <algorithm>
 #include <fstream>
+#include <mutex>
 #include <sstream>
 
 namespace Camel
 {
+	namespace
+	{
+		// Names of every handle, indexed by id
+		struct UniformRegistry
+		{
+			std::mutex mutex;
+			std::vector<std::string> names;
+			std::vector<uint32_t> hashes;
+		};
+
+		UniformRegistry& GetUniformRegistry()
+		{
+			static UniformRegistry registry;
+			return registry;
+		}
+	}
+
+	uint32_t RegisterUniform(const std::string_view name)
+	{
+		const uint32_t hash = HashUniformName(name);
+
+		UniformRegistry& registry = GetUniformRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		// Handles are created once, a linear search is fine
+		for (size_t i = 0; i < registry.hashes.size(); i++)
+		{
+			if (registry.hashes[i] == hash)
+			{
+				CAMEL_ASSERT(registry.names[i] == name, "Uniform names {} and {} have the same hash", registry.names[i], name);
+				return (uint32_t)i;
+			}
+		}
+
+		registry.names.emplace_back(name);
+		registry.hashes.push_back(hash);
+		return (uint32_t)(registry.hashes.size() - 1);
+	}
+
 	Shader Shader::Load(const std::string& vertexFilePath, const std::string& fragmentFilePath)
+	{
+		ShaderSources sources = Read(vertexFilePath, fragmentFilePath);
+		return Shader(sources.vertex, sources.fragment);
+	}
+
+	ShaderSources Shader::Read(const std::string& vertexFilePath, const std::string& fragmentFilePath)
 	{
 		std::ifstream vertexFile(vertexFilePath);
 		if (!vertexFile)
@@ -28,11 +78,110 @@ namespace Camel
 		vertexFile.close();
 		fragmentFile.close();
 
-		return Shader(vertexStream.str(), fragmentStream.str());
+		return { vertexStream.str(), fragmentStream.str() };
+	}
+
+	Shader Shader::CompileAsync(const std::string& vertexSource, const std::string& fragmentSource)
+	{
+		Shader shader;
+		shader.Submit(vertexSource, fragmentSource);
+		return shader;
+	}
+
+	Shader::Shader() noexcept
+		: m_ShaderID(0), m_VertexID(0), m_FragmentID(0), m_CacheKey(0), m_IsCached(false), m_IsReady(false), m_ReadsInstanceData(false)
+	{
 	}
 
 	Shader::Shader(const std::string& vertexSource, const std::string& fragmentSource)
+		: Shader()
+	{
+		Submit(vertexSource, fragmentSource);
+		if (!m_IsReady)
+			Finish();
+	}
+
+	Shader::Shader(Shader&& other) noexcept
+		: m_ShaderID(other.m_ShaderID), m_VertexID(other.m_VertexID), m_FragmentID(other.m_FragmentID), m_CacheKey(other.m_CacheKey),
+		m_IsCached(other.m_IsCached), m_IsReady(other.m_IsReady), m_ReadsInstanceData(other.m_ReadsInstanceData), m_Uniforms(std::move(other.m_Uniforms)),
+		m_ResolvedUniforms(std::move(other.m_ResolvedUniforms)), m_NamedUniforms(std::move(other.m_NamedUniforms))
 	{
+		other.m_ShaderID = 0;
+		other.m_VertexID = 0;
+		other.m_FragmentID = 0;
+		other.m_IsReady = false;
+	}
+
+	Shader& Shader::operator=(Shader&& other) noexcept
+	{
+		if (this != &other)
+		{
+			GLState::DeleteProgram(m_ShaderID);
+			glDeleteShader(m_VertexID);
+			glDeleteShader(m_FragmentID);
+
+			m_ShaderID = other.m_ShaderID;
+			m_VertexID = other.m_VertexID;
+			m_FragmentID = other.m_FragmentID;
+			m_CacheKey = other.m_CacheKey;
+			m_IsCached = other.m_IsCached;
+			m_IsReady = other.m_IsReady;
+			m_ReadsInstanceData = other.m_ReadsInstanceData;
+			m_Uniforms = std::move(other.m_Uniforms);
+			m_ResolvedUniforms = std::move(other.m_ResolvedUniforms);
+			m_NamedUniforms = std::move(other.m_NamedUniforms);
+
+			other.m_ShaderID = 0;
+			other.m_VertexID = 0;
+			other.m_FragmentID = 0;
+			other.m_IsReady = false;
+		}
+		return *this;
+	}
+
+	Shader::~Shader() noexcept
+	{
+		GLState::DeleteProgram(m_ShaderID);
+		glDeleteShader(m_VertexID);
+		glDeleteShader(m_FragmentID);
+	}
+
+	bool Shader::Poll()
+	{
+		if (m_IsReady)
+			return true;
+
+		// Without the extension the status queries below wait for the driver, which still had the time since Submit
+		if (HasParallelCompile())
+		{
+			GLint isComplete = GL_FALSE;
+			glGetProgramiv(m_ShaderID, GL_COMPLETION_STATUS_KHR, &isComplete);
+			if (!isComplete)
+				return false;
+		}
+
+		Finish();
+		return true;
+	}
+
+	bool Shader::HasParallelCompile() noexcept
+	{
+		static const bool hasParallelCompile = []()
+		{
+			if (!GLEW_KHR_parallel_shader_compile)
+				return false;
+
+			// Let the driver pick how many compiler threads to use
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+			return true;
+		}();
+		return hasParallelCompile;
+	}
+
+	void Shader::Submit(const std::string& vertexSource, const std::string& fragmentSource)
+	{
+		HasParallelCompile();
+
 		m_ShaderID = glCreateProgram();
 		if (!m_ShaderID)
 		{
@@ -40,17 +189,44 @@ namespace Camel
 			throw std::runtime_error("Failed to create shader program");
 		}
 
-		GLuint vs = CompileShader(GL_VERTEX_SHADER, vertexSource);
-		GLuint fs = CompileShader(GL_FRAGMENT_SHADER, fragmentSource);
+		// A cache hit skips compiling, linking and validating entirely
+		m_IsCached = ProgramCache::IsEnabled();
+		m_CacheKey = m_IsCached ? ProgramCache::ComputeKey(vertexSource, fragmentSource) : 0;
+		if (m_IsCached)
+		{
+			if (ProgramCache::Load(m_ShaderID, m_CacheKey))
+			{
+				Reflect();
+				BindUniformBlocks();
+				m_IsReady = true;
+				return;
+			}
+
+			// The program may hold a rejected binary, start over with a fresh one
+			GLState::DeleteProgram(m_ShaderID);
+			m_ShaderID = glCreateProgram();
+			glProgramParameteri(m_ShaderID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
+		// No status queries here, they would wait for each stage in turn
+		m_VertexID = CompileShader(GL_VERTEX_SHADER, vertexSource);
+		m_FragmentID = CompileShader(GL_FRAGMENT_SHADER, fragmentSource);
 
-		glAttachShader(m_ShaderID, vs);
-		glAttachShader(m_ShaderID, fs);
+		glAttachShader(m_ShaderID, m_VertexID);
+		glAttachShader(m_ShaderID, m_FragmentID);
 		glLinkProgram(m_ShaderID);
+	}
 
+	void Shader::Finish()
+	{
 		GLint success;
 		glGetProgramiv(m_ShaderID, GL_LINK_STATUS, &success);
 		if (!success)
 		{
+			// A stage that failed to compile explains the failure better than the link log
+			CheckCompileStatus(m_VertexID, GL_VERTEX_SHADER);
+			CheckCompileStatus(m_FragmentID, GL_FRAGMENT_SHADER);
+
 			GLint length = 0;
 			glGetProgramiv(m_ShaderID, GL_INFO_LOG_LENGTH, &length);
 
@@ -85,50 +261,171 @@ namespace Camel
 			throw std::runtime_error("Shader program validation failed");
 		}
 
-		glDeleteShader(vs);
-		glDeleteShader(fs);
+		glDetachShader(m_ShaderID, m_VertexID);
+		glDetachShader(m_ShaderID, m_FragmentID);
+		glDeleteShader(m_VertexID);
+		glDeleteShader(m_FragmentID);
+		m_VertexID = 0;
+		m_FragmentID = 0;
+
+		if (m_IsCached)
+			ProgramCache::Store(m_ShaderID, m_CacheKey);
+
+		Reflect();
+		BindUniformBlocks();
+		m_IsReady = true;
 	}
 
-	Shader::Shader(Shader&& other) noexcept
-		: m_ShaderID(other.m_ShaderID), m_UniformLocationCache(std::move(other.m_UniformLocationCache))
+	void Shader::Reflect()
 	{
-		other.m_ShaderID = 0;
+		GLint count = 0, maxLength = 0;
+		glGetProgramiv(m_ShaderID, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(m_ShaderID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+		std::string name(std::max(maxLength, 1), '\0');
+		m_Uniforms.clear();
+		m_Uniforms.reserve(count);
+		for (GLint i = 0; i < count; i++)
+		{
+			GLsizei length = 0;
+			GLint size = 0;
+			GLenum type = 0;
+			glGetActiveUniform(m_ShaderID, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+
+			// Members of uniform blocks have no location
+			const GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+			if (location == -1)
+				continue;
+
+			std::string_view uniformName(name.data(), length);
+			if (uniformName.ends_with("[0]"))
+				uniformName.remove_suffix(3);
+
+			m_Uniforms.push_back({ std::string(uniformName), HashUniformName(uniformName), location, type, size });
+		}
+
+		std::sort(m_Uniforms.begin(), m_Uniforms.end(), [](const UniformInfo& a, const UniformInfo& b) { return a.hash < b.hash; });
+
+		for (size_t i = 1; i < m_Uniforms.size(); i++)
+			CAMEL_ASSERT(m_Uniforms[i - 1].hash != m_Uniforms[i].hash, "Uniforms {} and {} have the same hash", m_Uniforms[i - 1].name, m_Uniforms[i].name);
+
+		m_ResolvedUniforms.clear();
+		m_NamedUniforms.clear();
+
+		// The first column of the instance matrix marks a shader written for InstanceBuffer
+		GLint attributeCount = 0;
+		glGetProgramiv(m_ShaderID, GL_ACTIVE_ATTRIBUTES, &attributeCount);
+		glGetProgramiv(m_ShaderID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+
+		std::string attributeName(std::max(maxLength, 1), '\0');
+		m_ReadsInstanceData = false;
+		for (GLint i = 0; i < attributeCount && !m_ReadsInstanceData; i++)
+		{
+			GLsizei length = 0;
+			GLint size = 0;
+			GLenum type = 0;
+			glGetActiveAttrib(m_ShaderID, (GLuint)i, (GLsizei)attributeName.size(), &length, &size, &type, attributeName.data());
+			m_ReadsInstanceData = type == GL_FLOAT_MAT4 && glGetAttribLocation(m_ShaderID, attributeName.c_str()) == INSTANCE_MODEL_ATTRIBUTE_LOCATION;
+		}
 	}
 
-	Shader& Shader::operator=(Shader&& other) noexcept
+	void Shader::BindUniformBlocks() const
 	{
-		if (this != &other)
+		GLint count = 0, maxLength = 0;
+		glGetProgramiv(m_ShaderID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+		glGetProgramiv(m_ShaderID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+
+		std::string name(std::max(maxLength, 1), '\0');
+		for (GLint i = 0; i < count; i++)
 		{
-			glDeleteProgram(m_ShaderID);
+			GLsizei length = 0;
+			glGetActiveUniformBlockName(m_ShaderID, (GLuint)i, (GLsizei)name.size(), &length, name.data());
 
-			m_ShaderID = other.m_ShaderID;
-			m_UniformLocationCache = std::move(other.m_UniformLocationCache);
+			const std::string_view blockName(name.data(), length);
+			const auto block = std::find_if(std::begin(UNIFORM_BLOCKS), std::end(UNIFORM_BLOCKS), [&](const UniformBlockInfo& info) { return info.name == blockName; });
+			if (block == std::end(UNIFORM_BLOCKS))
+			{
+				CAMEL_LOG_WARN("Uniform block {} has no binding point and will read binding 0", blockName);
+				continue;
+			}
 
-			other.m_ShaderID = 0;
+			GLint size = 0;
+			glGetActiveUniformBlockiv(m_ShaderID, (GLuint)i, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+			CAMEL_ASSERT((size_t)size <= block->size, "Uniform block {} is {} bytes in the shader but {} bytes on the CPU", blockName, size, block->size);
+
+			glUniformBlockBinding(m_ShaderID, (GLuint)i, block->binding);
 		}
-		return *this;
 	}
 
-	Shader::~Shader() noexcept
+	const UniformInfo* Shader::FindUniform(const uint32_t hash) const noexcept
 	{
-		glDeleteProgram(m_ShaderID);
+		auto found = std::lower_bound(m_Uniforms.begin(), m_Uniforms.end(), hash, [](const UniformInfo& uniform, const uint32_t value) { return uniform.hash < value; });
+		return found != m_Uniforms.end() && found->hash == hash ? &*found : nullptr;
 	}
 
-	GLint Shader::GetUniformLocation(const std::string& name)
+	GLint Shader::GetUniformLocation(std::string_view name)
 	{
-		auto found = m_UniformLocationCache.find(name);
-		if (found != m_UniformLocationCache.end())
-			return found->second;
-
-		GLint location = glGetUniformLocation(m_ShaderID, name.c_str());
+		// Names are compared as well, a different name can have the same hash
+		const uint32_t hash = HashUniformName(name);
+		if (const UniformInfo* uniform = FindUniform(hash); uniform && uniform->name == name)
+			return uniform->location;
+
+		for (const NamedUniform& uniform : m_NamedUniforms)
+			if (uniform.hash == hash && uniform.name == name)
+				return uniform.location;
+
+		// Array elements such as u_Lights[2] are only known to the driver
+		std::string nameString(name);
+		const GLint location = glGetUniformLocation(m_ShaderID, nameString.c_str());
 		if (location == -1)
 			CAMEL_LOG_WARN("Uniform {} does not exist or is not being used by the shader", name);
 
-		m_UniformLocationCache.emplace(name, location);
-
+		m_NamedUniforms.push_back({ std::move(nameString), hash, location });
 		return location;
 	}
 
+	void Shader::ResolveUniforms()
+	{
+		UniformRegistry& registry = GetUniformRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		for (size_t id = m_ResolvedUniforms.size(); id < registry.hashes.size(); id++)
+		{
+			const UniformInfo* uniform = FindUniform(registry.hashes[id]);
+			m_ResolvedUniforms.push_back(uniform ? ResolvedUniform{ uniform->location, uniform->type } : ResolvedUniform{ -1, 0 });
+		}
+	}
+
+	bool Shader::IsCompatibleType(const GLenum declared, const GLenum set) noexcept
+	{
+		if (declared == set)
+			return true;
+
+		// Booleans and samplers are set through glUniform1i
+		if (set != GL_INT)
+			return false;
+
+		switch (declared)
+		{
+		case GL_BOOL:
+		case GL_SAMPLER_1D:
+		case GL_SAMPLER_2D:
+		case GL_SAMPLER_3D:
+		case GL_SAMPLER_CUBE:
+		case GL_SAMPLER_2D_SHADOW:
+		case GL_SAMPLER_2D_ARRAY:
+		case GL_SAMPLER_2D_ARRAY_SHADOW:
+		case GL_SAMPLER_CUBE_SHADOW:
+		case GL_SAMPLER_2D_MULTISAMPLE:
+		case GL_SAMPLER_BUFFER:
+		case GL_INT_SAMPLER_2D:
+		case GL_UNSIGNED_INT_SAMPLER_2D:
+			return true;
+		default:
+			return false;
+		}
+	}
+
 	GLuint Shader::CompileShader(const GLenum shaderType, const std::string& source) const
 	{
 		GLuint id = glCreateShader(shaderType);
@@ -142,6 +439,11 @@ namespace Camel
 		glShaderSource(id, 1, &src, nullptr);
 		glCompileShader(id);
 
+		return id;
+	}
+
+	void Shader::CheckCompileStatus(const GLuint id, const GLenum shaderType) const
+	{
 		GLint success;
 		glGetShaderiv(id, GL_COMPILE_STATUS, &success);
 		if (!success)
@@ -152,19 +454,14 @@ namespace Camel
 			char* message = (char*)_malloca(length * sizeof(char));
 			if (!message)
 			{
-				glDeleteShader(id);
-
 				CAMEL_LOG_ERROR("Failed to allocate memory for shader compile error message");
 				throw std::runtime_error("Failed to allocate memory for shader compile error message");
 			}
 
 			glGetShaderInfoLog(id, length, &length, message);
-			glDeleteShader(id);
 
 			CAMEL_LOG_ERROR("Failed to compile {} shader! Message: {}", (shaderType == GL_VERTEX_SHADER ? "vertex" : "fragment"), message);
 			throw std::runtime_error("Failed to compile shader");
 		}
-
-		return id;
 	}
 }
\ No newline at end of file
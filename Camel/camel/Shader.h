@@ -1,18 +1,104 @@
 #pragma once
 
 #include "Core.h"
+#include "GLState.h"
 
-#include <unordered_map>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 #include <glm/gtc/type_ptr.hpp>
 
 namespace Camel
 {
+	// FNV-1a, constexpr so names written in code can be hashed at compile time
+	constexpr uint32_t HashUniformName(const std::string_view name) noexcept
+	{
+		uint32_t hash = 2166136261u;
+		for (const char c : name)
+			hash = (hash ^ (uint8_t)c) * 16777619u;
+		return hash;
+	}
+
+	// Gives every uniform name used through a handle a small id shared by all shaders, thread safe
+	uint32_t RegisterUniform(const std::string_view name);
+
+	// GL type a value uploads as and the call that uploads it
+	template<typename T>
+	struct UniformTraits;
+
+	template<> struct UniformTraits<GLint> { static constexpr GLenum TYPE = GL_INT; static inline void Upload(const GLint location, const GLint& value) noexcept { glUniform1i(location, value); } };
+	template<> struct UniformTraits<glm::ivec2> { static constexpr GLenum TYPE = GL_INT_VEC2; static inline void Upload(const GLint location, const glm::ivec2& value) noexcept { glUniform2iv(location, 1, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::ivec3> { static constexpr GLenum TYPE = GL_INT_VEC3; static inline void Upload(const GLint location, const glm::ivec3& value) noexcept { glUniform3iv(location, 1, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::ivec4> { static constexpr GLenum TYPE = GL_INT_VEC4; static inline void Upload(const GLint location, const glm::ivec4& value) noexcept { glUniform4iv(location, 1, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<GLuint> { static constexpr GLenum TYPE = GL_UNSIGNED_INT; static inline void Upload(const GLint location, const GLuint& value) noexcept { glUniform1ui(location, value); } };
+	template<> struct UniformTraits<glm::uvec2> { static constexpr GLenum TYPE = GL_UNSIGNED_INT_VEC2; static inline void Upload(const GLint location, const glm::uvec2& value) noexcept { glUniform2uiv(location, 1, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::uvec3> { static constexpr GLenum TYPE = GL_UNSIGNED_INT_VEC3; static inline void Upload(const GLint location, const glm::uvec3& value) noexcept { glUniform3uiv(location, 1, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::uvec4> { static constexpr GLenum TYPE = GL_UNSIGNED_INT_VEC4; static inline void Upload(const GLint location, const glm::uvec4& value) noexcept { glUniform4uiv(location, 1, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<GLfloat> { static constexpr GLenum TYPE = GL_FLOAT; static inline void Upload(const GLint location, const GLfloat& value) noexcept { glUniform1f(location, value); } };
+	template<> struct UniformTraits<glm::vec2> { static constexpr GLenum TYPE = GL_FLOAT_VEC2; static inline void Upload(const GLint location, const glm::vec2& value) noexcept { glUniform2fv(location, 1, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::vec3> { static constexpr GLenum TYPE = GL_FLOAT_VEC3; static inline void Upload(const GLint location, const glm::vec3& value) noexcept { glUniform3fv(location, 1, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::vec4> { static constexpr GLenum TYPE = GL_FLOAT_VEC4; static inline void Upload(const GLint location, const glm::vec4& value) noexcept { glUniform4fv(location, 1, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::mat2> { static constexpr GLenum TYPE = GL_FLOAT_MAT2; static inline void Upload(const GLint location, const glm::mat2& value) noexcept { glUniformMatrix2fv(location, 1, GL_FALSE, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::mat3> { static constexpr GLenum TYPE = GL_FLOAT_MAT3; static inline void Upload(const GLint location, const glm::mat3& value) noexcept { glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::mat4x3> { static constexpr GLenum TYPE = GL_FLOAT_MAT4x3; static inline void Upload(const GLint location, const glm::mat4x3& value) noexcept { glUniformMatrix4x3fv(location, 1, GL_FALSE, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::mat4> { static constexpr GLenum TYPE = GL_FLOAT_MAT4; static inline void Upload(const GLint location, const glm::mat4& value) noexcept { glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<GLdouble> { static constexpr GLenum TYPE = GL_DOUBLE; static inline void Upload(const GLint location, const GLdouble& value) noexcept { glUniform1d(location, value); } };
+	template<> struct UniformTraits<glm::dvec2> { static constexpr GLenum TYPE = GL_DOUBLE_VEC2; static inline void Upload(const GLint location, const glm::dvec2& value) noexcept { glUniform2dv(location, 1, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::dvec3> { static constexpr GLenum TYPE = GL_DOUBLE_VEC3; static inline void Upload(const GLint location, const glm::dvec3& value) noexcept { glUniform3dv(location, 1, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::dvec4> { static constexpr GLenum TYPE = GL_DOUBLE_VEC4; static inline void Upload(const GLint location, const glm::dvec4& value) noexcept { glUniform4dv(location, 1, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::dmat2> { static constexpr GLenum TYPE = GL_DOUBLE_MAT2; static inline void Upload(const GLint location, const glm::dmat2& value) noexcept { glUniformMatrix2dv(location, 1, GL_FALSE, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::dmat3> { static constexpr GLenum TYPE = GL_DOUBLE_MAT3; static inline void Upload(const GLint location, const glm::dmat3& value) noexcept { glUniformMatrix3dv(location, 1, GL_FALSE, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::dmat4x3> { static constexpr GLenum TYPE = GL_DOUBLE_MAT4x3; static inline void Upload(const GLint location, const glm::dmat4x3& value) noexcept { glUniformMatrix4x3dv(location, 1, GL_FALSE, glm::value_ptr(value)); } };
+	template<> struct UniformTraits<glm::dmat4> { static constexpr GLenum TYPE = GL_DOUBLE_MAT4; static inline void Upload(const GLint location, const glm::dmat4& value) noexcept { glUniformMatrix4dv(location, 1, GL_FALSE, glm::value_ptr(value)); } };
+
+	// Typed handle to a uniform by name, valid for every shader. Create it once, e.g. as a static, and the
+	// per-frame set is an index into the shader's location table with no string hashing
+	template<typename T>
+	class Uniform final
+	{
+	public:
+		explicit Uniform(const std::string_view name)
+			: m_ID(RegisterUniform(name))
+		{
+		}
+
+		inline uint32_t GetID() const noexcept { return m_ID; }
+
+	private:
+		uint32_t m_ID;
+	};
+
+	// An active uniform found when the program was linked, arrays are named without their [0]
+	struct UniformInfo
+	{
+		std::string name;
+		uint32_t hash;
+		GLint location;
+		GLenum type;
+		GLint size;
+	};
+
+	struct ShaderSources
+	{
+		std::string vertex;
+		std::string fragment;
+	};
+
 	class Shader final
 	{
 	public:
 		static Shader Load(const std::string& vertexFilePath, const std::string& fragmentFilePath);
 
+		// The file reading half of Load, makes no GL calls so it can run on any thread
+		static ShaderSources Read(const std::string& vertexFilePath, const std::string& fragmentFilePath);
+
+		// Submits compiling and linking without waiting for the driver. Create every shader needed first, then Poll them,
+		// with KHR_parallel_shader_compile the driver works on all of them in the background meanwhile
+		static Shader CompileAsync(const std::string& vertexSource, const std::string& fragmentSource);
+
 	public:
+		// Compiles and links before returning
 		Shader(const std::string& vertexSource, const std::string& fragmentSource);
 
 		Shader(const Shader&) = delete;
@@ -23,202 +109,277 @@ namespace Camel
 
 		~Shader() noexcept;
 
+		// True once the program is linked and usable, never blocks with KHR_parallel_shader_compile.
+		// Throws when compiling or linking failed
+		bool Poll();
+		inline bool IsReady() const noexcept { return m_IsReady; }
+
+		// Whether the vertex stage takes its model matrix from the per-instance attributes of an InstanceBuffer
+		inline bool ReadsInstanceData() const noexcept { return m_ReadsInstanceData; }
+
 		inline void Bind() const noexcept
 		{
-			glUseProgram(m_ShaderID);
+			GLState::UseProgram(m_ShaderID);
 		}
 
 		inline void Unbind() const noexcept
 		{
-			glUseProgram(0);
+			GLState::UseProgram(0);
 		}
 
-		inline void SetUniform1i(const std::string& name, const GLint value) noexcept
+		template<typename T>
+		inline void SetUniform(const Uniform<T>& uniform, const std::type_identity_t<T>& value) noexcept
+		{
+			UniformTraits<T>::Upload(GetUniformLocation(uniform.GetID(), UniformTraits<T>::TYPE), value);
+		}
+
+		inline void SetUniform1i(std::string_view name, const GLint value) noexcept
 		{
 			glUniform1i(GetUniformLocation(name), value);
 		}
 
-		inline void SetUniform2i(const std::string& name, const GLint v0, const GLint v1) noexcept
+		inline void SetUniform2i(std::string_view name, const GLint v0, const GLint v1) noexcept
 		{
 			glUniform2i(GetUniformLocation(name), v0, v1);
 		}
 
-		inline void SetUniform2i(const std::string& name, const glm::ivec2& value) noexcept
+		inline void SetUniform2i(std::string_view name, const glm::ivec2& value) noexcept
 		{
 			glUniform2iv(GetUniformLocation(name), 1, glm::value_ptr(value));
 		}
 
-		inline void SetUniform3i(const std::string& name, const GLint v0, const GLint v1, const GLint v2) noexcept
+		inline void SetUniform3i(std::string_view name, const GLint v0, const GLint v1, const GLint v2) noexcept
 		{
 			glUniform3i(GetUniformLocation(name), v0, v1, v2);
 		}
 
-		inline void SetUniform3i(const std::string& name, const glm::ivec3& value) noexcept
+		inline void SetUniform3i(std::string_view name, const glm::ivec3& value) noexcept
 		{
 			glUniform3iv(GetUniformLocation(name), 1, glm::value_ptr(value));
 		}
 
-		inline void SetUniform4i(const std::string& name, const GLint v0, const GLint v1, const GLint v2, const GLint v3) noexcept
+		inline void SetUniform4i(std::string_view name, const GLint v0, const GLint v1, const GLint v2, const GLint v3) noexcept
 		{
 			glUniform4i(GetUniformLocation(name), v0, v1, v2, v3);
 		}
 
-		inline void SetUniform4i(const std::string& name, const glm::ivec4& value) noexcept
+		inline void SetUniform4i(std::string_view name, const glm::ivec4& value) noexcept
 		{
 			glUniform4iv(GetUniformLocation(name), 1, glm::value_ptr(value));
 		}
 
-		inline void SetUniform1u(const std::string& name, const GLuint value) noexcept
+		inline void SetUniform1u(std::string_view name, const GLuint value) noexcept
 		{
 			glUniform1ui(GetUniformLocation(name), value);
 		}
 
-		inline void SetUniform2u(const std::string& name, const GLuint v0, const GLuint v1) noexcept
+		inline void SetUniform2u(std::string_view name, const GLuint v0, const GLuint v1) noexcept
 		{
 			glUniform2ui(GetUniformLocation(name), v0, v1);
 		}
 
-		inline void SetUniform2u(const std::string& name, const glm::uvec2& value) noexcept
+		inline void SetUniform2u(std::string_view name, const glm::uvec2& value) noexcept
 		{
 			glUniform2uiv(GetUniformLocation(name), 1, glm::value_ptr(value));
 		}
 
-		inline void SetUniform3u(const std::string& name, const GLuint v0, const GLuint v1, const GLuint v2) noexcept
+		inline void SetUniform3u(std::string_view name, const GLuint v0, const GLuint v1, const GLuint v2) noexcept
 		{
 			glUniform3ui(GetUniformLocation(name), v0, v1, v2);
 		}
 
-		inline void SetUniform3u(const std::string& name, const glm::uvec3& value) noexcept
+		inline void SetUniform3u(std::string_view name, const glm::uvec3& value) noexcept
 		{
 			glUniform3uiv(GetUniformLocation(name), 1, glm::value_ptr(value));
 		}
 
-		inline void SetUniform4u(const std::string& name, const GLuint v0, const GLuint v1, const GLuint v2, const GLuint v3) noexcept
+		inline void SetUniform4u(std::string_view name, const GLuint v0, const GLuint v1, const GLuint v2, const GLuint v3) noexcept
 		{
 			glUniform4ui(GetUniformLocation(name), v0, v1, v2, v3);
 		}
 
-		inline void SetUniform4u(const std::string& name, const glm::uvec4& value) noexcept
+		inline void SetUniform4u(std::string_view name, const glm::uvec4& value) noexcept
 		{
 			glUniform4uiv(GetUniformLocation(name), 1, glm::value_ptr(value));
 		}
 
-		inline void SetUniform1f(const std::string& name, const GLfloat value) noexcept
+		inline void SetUniform1f(std::string_view name, const GLfloat value) noexcept
 		{
 			glUniform1f(GetUniformLocation(name), value);
 		}
 
-		inline void SetUniform2f(const std::string& name, const GLfloat v0, const GLfloat v1) noexcept
+		inline void SetUniform2f(std::string_view name, const GLfloat v0, const GLfloat v1) noexcept
 		{
 			glUniform2f(GetUniformLocation(name), v0, v1);
 		}
 
-		inline void SetUniform2f(const std::string& name, const glm::vec2& value) noexcept
+		inline void SetUniform2f(std::string_view name, const glm::vec2& value) noexcept
 		{
 			glUniform2fv(GetUniformLocation(name), 1, glm::value_ptr(value));
 		}
 
-		inline void SetUniform3f(const std::string& name, const GLfloat v0, const GLfloat v1, const GLfloat v2) noexcept
+		inline void SetUniform3f(std::string_view name, const GLfloat v0, const GLfloat v1, const GLfloat v2) noexcept
 		{
 			glUniform3f(GetUniformLocation(name), v0, v1, v2);
 		}
 
-		inline void SetUniform3f(const std::string& name, const glm::vec3& value) noexcept
+		inline void SetUniform3f(std::string_view name, const glm::vec3& value) noexcept
 		{
 			glUniform3fv(GetUniformLocation(name), 1, glm::value_ptr(value));
 		}
 
-		inline void SetUniform4f(const std::string& name, const GLfloat v0, const GLfloat v1, const GLfloat v2, const GLfloat v3) noexcept
+		inline void SetUniform4f(std::string_view name, const GLfloat v0, const GLfloat v1, const GLfloat v2, const GLfloat v3) noexcept
 		{
 			glUniform4f(GetUniformLocation(name), v0, v1, v2, v3);
 		}
 
-		inline void SetUniform4f(const std::string& name, const glm::vec4& value) noexcept
+		inline void SetUniform4f(std::string_view name, const glm::vec4& value) noexcept
 		{
 			glUniform4fv(GetUniformLocation(name), 1, glm::value_ptr(value));
 		}
 
-		inline void SetUniformMatrix2f(const std::string& name, const glm::mat2& value) noexcept
+		inline void SetUniformMatrix2f(std::string_view name, const glm::mat2& value) noexcept
 		{
 			glUniformMatrix2fv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
 		}
 
-		inline void SetUniformMatrix3f(const std::string& name, const glm::mat3& value) noexcept
+		inline void SetUniformMatrix3f(std::string_view name, const glm::mat3& value) noexcept
 		{
 			glUniformMatrix3fv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
 		}
 
-		inline void SetUniformMatrix4x3f(const std::string& name, const glm::mat4x3& value) noexcept
+		inline void SetUniformMatrix4x3f(std::string_view name, const glm::mat4x3& value) noexcept
 		{
 			glUniformMatrix4x3fv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
 		}
 
-		inline void SetUniformMatrix4f(const std::string& name, const glm::mat4& value) noexcept
+		inline void SetUniformMatrix4f(std::string_view name, const glm::mat4& value) noexcept
 		{
 			glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
 		}
 
-		inline void SetUniform1d(const std::string& name, const GLdouble value) noexcept
+		inline void SetUniform1d(std::string_view name, const GLdouble value) noexcept
 		{
 			glUniform1d(GetUniformLocation(name), value);
 		}
 
-		inline void SetUniform2d(const std::string& name, const GLdouble v0, const GLdouble v1) noexcept
+		inline void SetUniform2d(std::string_view name, const GLdouble v0, const GLdouble v1) noexcept
 		{
 			glUniform2d(GetUniformLocation(name), v0, v1);
 		}
 
-		inline void SetUniform2d(const std::string& name, const glm::dvec2& value) noexcept
+		inline void SetUniform2d(std::string_view name, const glm::dvec2& value) noexcept
 		{
 			glUniform2dv(GetUniformLocation(name), 1, glm::value_ptr(value));
 		}
 
-		inline void SetUniform3d(const std::string& name, const GLdouble v0, const GLdouble v1, const GLdouble v2) noexcept
+		inline void SetUniform3d(std::string_view name, const GLdouble v0, const GLdouble v1, const GLdouble v2) noexcept
 		{
 			glUniform3d(GetUniformLocation(name), v0, v1, v2);
 		}
 
-		inline void SetUniform3d(const std::string& name, const glm::dvec3& value) noexcept
+		inline void SetUniform3d(std::string_view name, const glm::dvec3& value) noexcept
 		{
 			glUniform3dv(GetUniformLocation(name), 1, glm::value_ptr(value));
 		}
 
-		inline void SetUniform4d(const std::string& name, const GLdouble v0, const GLdouble v1, const GLdouble v2, const GLdouble v3) noexcept
+		inline void SetUniform4d(std::string_view name, const GLdouble v0, const GLdouble v1, const GLdouble v2, const GLdouble v3) noexcept
 		{
 			glUniform4d(GetUniformLocation(name), v0, v1, v2, v3);
 		}
 
-		inline void SetUniform4d(const std::string& name, const glm::dvec4& value) noexcept
+		inline void SetUniform4d(std::string_view name, const glm::dvec4& value) noexcept
 		{
 			glUniform4dv(GetUniformLocation(name), 1, glm::value_ptr(value));
 		}
 
-		inline void SetUniformMatrix2d(const std::string& name, const glm::dmat2& value) noexcept
+		inline void SetUniformMatrix2d(std::string_view name, const glm::dmat2& value) noexcept
 		{
 			glUniformMatrix2dv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
 		}
 
-		inline void SetUniformMatrix3d(const std::string& name, const glm::dmat3& value) noexcept
+		inline void SetUniformMatrix3d(std::string_view name, const glm::dmat3& value) noexcept
 		{
 			glUniformMatrix3dv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
 		}
 
-		inline void SetUniformMatrix4x3d(const std::string& name, const glm::dmat4x3& value) noexcept
+		inline void SetUniformMatrix4x3d(std::string_view name, const glm::dmat4x3& value) noexcept
 		{
 			glUniformMatrix4x3dv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
 		}
 
-		inline void SetUniformMatrix4d(const std::string& name, const glm::dmat4& value) noexcept
+		inline void SetUniformMatrix4d(std::string_view name, const glm::dmat4& value) noexcept
 		{
 			glUniformMatrix4dv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
 		}
 
+		// Sorted by name hash
+		inline std::span<const UniformInfo> GetUniforms() const noexcept { return m_Uniforms; }
+
 	private:
+		// Location of a handle's uniform in this program, -1 when it has none
+		struct ResolvedUniform
+		{
+			GLint location;
+			GLenum type;
+		};
+
+		// Location the driver returned for a name that is not in m_Uniforms, such as an element of an array
+		struct NamedUniform
+		{
+			std::string name;
+			uint32_t hash;
+			GLint location;
+		};
+
+		Shader() noexcept;
+
+		// Enables the extension on first use
+		static bool HasParallelCompile() noexcept;
+
+		// Loads the program from the cache or starts compiling and linking it
+		void Submit(const std::string& vertexSource, const std::string& fragmentSource);
+
+		// Checks the results of Submit, waiting for the driver if it is not done
+		void Finish();
+
 		GLuint CompileShader(const GLenum shaderType, const std::string& source) const;
-		GLint GetUniformLocation(const std::string& name);
+		void CheckCompileStatus(const GLuint id, const GLenum shaderType) const;
+
+		// Reads the active uniforms of the linked program into m_Uniforms and checks for instance attributes
+		void Reflect();
+
+		// Points every block named in UNIFORM_BLOCKS at its binding point
+		void BindUniformBlocks() const;
+
+		const UniformInfo* FindUniform(const uint32_t hash) const noexcept;
+		GLint GetUniformLocation(std::string_view name);
+
+		inline GLint GetUniformLocation(const uint32_t id, [[maybe_unused]] const GLenum type) noexcept
+		{
+			// Handles registered after the last resolve are looked up once
+			if (id >= m_ResolvedUniforms.size())
+				ResolveUniforms();
+
+			const ResolvedUniform& uniform = m_ResolvedUniforms[id];
+			CAMEL_ASSERT(uniform.location == -1 || IsCompatibleType(uniform.type, type), "Uniform {} is set as GL type 0x{:X} but declared as 0x{:X}", id, type, uniform.type);
+			return uniform.location;
+		}
+
+		void ResolveUniforms();
+
+		static bool IsCompatibleType(const GLenum declared, const GLenum set) noexcept;
 
 	private:
 		GLuint m_ShaderID;
-		std::unordered_map<std::string, GLint> m_UniformLocationCache;
+		GLuint m_VertexID, m_FragmentID; // Stages still being compiled, 0 once linked
+		uint64_t m_CacheKey;
+		bool m_IsCached;
+		bool m_IsReady;
+		bool m_ReadsInstanceData;
+
+		std::vector<UniformInfo> m_Uniforms;
+		std::vector<ResolvedUniform> m_ResolvedUniforms; // Indexed by handle id
+		std::vector<NamedUniform> m_NamedUniforms; // String lookups the reflected table could not answer
 	};
 }
\ No newline at end of file
@@ -6,7 +6,13 @@ namespace Camel
 {
 	Texture Texture::Load(const std::string& filePath, const Texture::FilterMode filterMode)
 	{
-		stbi_set_flip_vertically_on_load(1);
+		return Texture(Decode(filePath), filterMode);
+	}
+
+	TextureImage Texture::Decode(const std::string& filePath)
+	{
+		// The per thread flag keeps concurrent decodes from racing on stb's global one
+		stbi_set_flip_vertically_on_load_thread(1);
 		int width, height, numChannels;
 		unsigned char* imageBuffer = stbi_load(filePath.c_str(), &width, &height, &numChannels, STBI_rgb_alpha);
 		if (!imageBuffer)
@@ -15,16 +21,24 @@ namespace Camel
 			throw std::runtime_error("Failed to load texture from path: " + filePath);
 		}
 
-		Texture texture(width, height, STBI_rgb_alpha, filterMode, imageBuffer);
+		TextureImage image;
+		image.width = width;
+		image.height = height;
+		image.numChannels = STBI_rgb_alpha;
+		image.pixels.assign(imageBuffer, imageBuffer + (size_t)width * height * STBI_rgb_alpha);
 		stbi_image_free(imageBuffer);
-		return texture;
+		return image;
 	}
 
+	Texture::Texture(const TextureImage& image, const FilterMode filterMode)
+		: Texture(image.width, image.height, image.numChannels, filterMode, image.pixels.data())
+	{}
+
 	Texture::Texture(const int width, const int height, const int numChannels, const FilterMode filterMode, const unsigned char* imageBuffer)
 		: m_Width(width), m_Height(height), m_NumChannels(numChannels)
 	{
 		glGenTextures(1, &m_TextureID);
-		glBindTexture(GL_TEXTURE_2D, m_TextureID);
+		GLState::BindTexture(0, m_TextureID);
 
 		// Minification filter
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLenum)filterMode);
@@ -51,7 +65,7 @@ namespace Camel
 		}
 
 		// Unbind
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GLState::BindTexture(0, 0);
 
 		// If imageBuffer is provided, fill m_PixelData from imageBuffer
 		if (imageBuffer)
@@ -72,7 +86,7 @@ namespace Camel
 	{
 		if (this != &other)
 		{
-			glDeleteTextures(1, &m_TextureID);
+			GLState::DeleteTexture(m_TextureID);
 
 			m_TextureID = other.m_TextureID;
 			m_Width = other.m_Width;
@@ -87,7 +101,7 @@ namespace Camel
 
 	Texture::~Texture() noexcept
 	{
-		glDeleteTextures(1, &m_TextureID);
+		GLState::DeleteTexture(m_TextureID);
 	}
 
 	void Texture::SetPixel(int x, int y, unsigned char r, unsigned char g, unsigned char b, unsigned char a)
@@ -102,7 +116,7 @@ namespace Camel
 
 	void Texture::UpdateTexture()
 	{
-		glBindTexture(GL_TEXTURE_2D, m_TextureID);
+		GLState::BindTexture(0, m_TextureID);
 		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, m_PixelData.data());
 	}
 }
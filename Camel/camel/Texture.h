@@ -1,11 +1,21 @@
 #pragma once
 
 #include "Core.h"
+#include "GLState.h"
 
 #include <vector>
 
 namespace Camel
 {
+	// Decoded pixels, bottom row first as OpenGL expects
+	struct TextureImage
+	{
+		int width = 0;
+		int height = 0;
+		int numChannels = 0;
+		std::vector<unsigned char> pixels;
+	};
+
 	class Texture final
 	{
 	public:
@@ -22,8 +32,12 @@ namespace Camel
 	public:
 		static Texture Load(const std::string& filePath, const FilterMode filterMode = FilterMode::LINEAR);
 
+		// The decoding half of Load, makes no GL calls so it can run on any thread
+		static TextureImage Decode(const std::string& filePath);
+
 	public:
 		Texture(const int width, const int height, const int numChannels, const FilterMode filterMode = FilterMode::LINEAR, const unsigned char* imageBuffer = nullptr);
+		Texture(const TextureImage& image, const FilterMode filterMode = FilterMode::LINEAR);
 
 		Texture(const Texture&) = delete;
 		Texture& operator=(const Texture&) = delete;
@@ -35,14 +49,12 @@ namespace Camel
 
 		inline void Bind(unsigned int slot = 0) const noexcept
 		{
-			CAMEL_ASSERT(slot >= 0 && slot <= 31, "Cannot bind texture to slot {}. Acceptable values are 0 to 31.", slot);
-			glActiveTexture(GL_TEXTURE0 + slot);
-			glBindTexture(GL_TEXTURE_2D, m_TextureID);
+			GLState::BindTexture(slot, m_TextureID);
 		}
 
-		inline void Unbind() const noexcept
+		inline void Unbind(unsigned int slot = 0) const noexcept
 		{
-			glBindTexture(GL_TEXTURE_2D, 0);
+			GLState::BindTexture(slot, 0);
 		}
 
 		inline int GetWidth() const noexcept { return m_Width; }
@@ -0,0 +1,289 @@
+#include "TransformHierarchy.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace Camel
+{
+	namespace
+	{
+		constexpr size_t UPDATE_BATCH_SIZE = 1024;
+
+		// Runs function(begin, end) over [begin, end), in parallel batches when a job system is given
+		template<typename Function>
+		void ForRange(JobSystem* jobSystem, const size_t begin, const size_t end, Function&& function)
+		{
+			if (!jobSystem)
+			{
+				function(begin, end);
+				return;
+			}
+
+			jobSystem->ParallelFor(end - begin, UPDATE_BATCH_SIZE, [begin, &function](const size_t first, const size_t last)
+			{
+				function(begin + first, begin + last);
+			});
+		}
+
+		template<typename T>
+		void Permute(std::vector<T>& values, const std::vector<uint32_t>& order)
+		{
+			std::vector<T> sorted;
+			sorted.reserve(order.size());
+			for (const uint32_t index : order)
+				sorted.push_back(values[index]);
+			values = std::move(sorted);
+		}
+	}
+
+	uint32_t TransformHierarchy::Create(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+	{
+		uint32_t id;
+		if (!m_FreeIDs.empty())
+		{
+			id = m_FreeIDs.back();
+			m_FreeIDs.pop_back();
+		}
+		else
+		{
+			id = (uint32_t)m_IDToIndex.size();
+			m_IDToIndex.push_back(INVALID_INDEX);
+		}
+
+		// New nodes are roots, appending them keeps the order valid
+		m_IDToIndex[id] = (uint32_t)m_IDs.size();
+		m_IDs.push_back(id);
+		m_Parents.push_back(INVALID_INDEX);
+		m_Positions.push_back(position);
+		m_Rotations.push_back(rotation);
+		m_Scales.push_back(scale);
+		m_WorldMatrices.push_back(glm::mat4(1.0f));
+		m_InverseWorldMatrices.push_back(glm::mat4(1.0f));
+		m_Flags.push_back(DIRTY | INVERSE_STALE);
+		m_HasDirty = true;
+		return id;
+	}
+
+	void TransformHierarchy::Destroy(const uint32_t id)
+	{
+		const uint32_t index = m_IDToIndex[id];
+		CAMEL_ASSERT(index != INVALID_INDEX, "Transform {} is already destroyed.", id);
+
+		// The slot stays in place until the next rebuild, children skip over it to the closest live ancestor
+		m_Flags[index] |= DESTROYED;
+		MarkDirty(index);
+		m_IDToIndex[id] = INVALID_INDEX;
+		m_FreeIDs.push_back(id);
+		m_DestroyedCount++;
+	}
+
+	void TransformHierarchy::SetParent(const uint32_t id, const uint32_t parentID)
+	{
+		const uint32_t index = m_IDToIndex[id];
+		const uint32_t parent = parentID == INVALID_ID ? INVALID_INDEX : m_IDToIndex[parentID];
+
+		for (uint32_t ancestor = parent; ancestor != INVALID_INDEX; ancestor = ResolveParent(ancestor))
+			CAMEL_ASSERT(ancestor != index, "Transform {} cannot be parented to its own descendant {}.", id, parentID);
+
+		// Depth levels of the whole subtree change even when the order stays valid
+		m_Parents[index] = parent;
+		m_IsOrderDirty = true;
+		MarkDirty(index);
+	}
+
+	glm::mat4 TransformHierarchy::GetWorldMatrix(const uint32_t id)
+	{
+		const uint32_t index = m_IDToIndex[id];
+		if (!m_HasDirty)
+			return m_WorldMatrices[index];
+
+		// Find the topmost dirty node in the ancestor chain, everything above it is still cached
+		m_Chain.clear();
+		size_t topmostDirty = SIZE_MAX;
+		for (uint32_t node = index; node != INVALID_INDEX; node = m_Parents[node])
+		{
+			if (m_Flags[node] & DIRTY)
+				topmostDirty = m_Chain.size();
+			m_Chain.push_back(node);
+		}
+
+		if (topmostDirty == SIZE_MAX)
+			return m_WorldMatrices[index];
+
+		glm::mat4 world(1.0f);
+		for (size_t i = topmostDirty + 1; i < m_Chain.size(); i++)
+		{
+			if (!(m_Flags[m_Chain[i]] & DESTROYED))
+			{
+				world = m_WorldMatrices[m_Chain[i]];
+				break;
+			}
+		}
+
+		for (size_t i = topmostDirty + 1; i-- > 0;)
+		{
+			if (!(m_Flags[m_Chain[i]] & DESTROYED))
+				TransformMath::MultiplyAffine(world, CalculateLocalMatrix(m_Chain[i]), world);
+		}
+
+		// Flags are left alone so that Update() still refreshes the rest of the subtree
+		m_WorldMatrices[index] = world;
+		m_Flags[index] |= INVERSE_STALE;
+		return m_WorldMatrices[index];
+	}
+
+	glm::mat4 TransformHierarchy::GetInverseWorldMatrix(const uint32_t id)
+	{
+		const glm::mat4 world = GetWorldMatrix(id);
+		const uint32_t index = m_IDToIndex[id];
+		if (m_Flags[index] & INVERSE_STALE)
+		{
+			const uint32_t parent = ResolveParent(index);
+			m_InverseWorldMatrices[index] = parent == INVALID_INDEX
+				? TransformMath::InverseTRS(m_Positions[index], m_Rotations[index], m_Scales[index])
+				: TransformMath::InverseAffine(world);
+			m_Flags[index] &= ~INVERSE_STALE;
+		}
+		return m_InverseWorldMatrices[index];
+	}
+
+	void TransformHierarchy::Update(JobSystem* jobSystem)
+	{
+		if (m_IsOrderDirty || m_DestroyedCount > 0)
+			Rebuild();
+
+		if (!m_HasDirty)
+			return;
+
+		// Parents precede children, so a dirty flag reaches the whole subtree in a single forward pass
+		const size_t count = m_IDs.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			const uint32_t parent = m_Parents[i];
+			if (parent != INVALID_INDEX && (m_Flags[parent] & DIRTY))
+				m_Flags[i] |= DIRTY;
+		}
+
+		// Compose local matrices of contiguous dirty runs in batches, nodes do not depend on each other yet
+		ForRange(jobSystem, 0, count, [this](const size_t begin, const size_t end)
+		{
+			for (size_t i = begin; i < end;)
+			{
+				if (!(m_Flags[i] & DIRTY))
+				{
+					i++;
+					continue;
+				}
+
+				const size_t runBegin = i;
+				while (i < end && (m_Flags[i] & DIRTY))
+					i++;
+
+				TransformMath::ComposeTRS(&m_Positions[runBegin], &m_Rotations[runBegin], &m_Scales[runBegin], &m_WorldMatrices[runBegin], i - runBegin);
+			}
+		});
+
+		auto applyParents = [this](const size_t begin, const size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				if (!(m_Flags[i] & DIRTY))
+					continue;
+
+				const uint32_t parent = m_Parents[i];
+				if (parent != INVALID_INDEX)
+					TransformMath::MultiplyAffine(m_WorldMatrices[parent], m_WorldMatrices[i], m_WorldMatrices[i]);
+				m_Flags[i] = (m_Flags[i] & ~DIRTY) | INVERSE_STALE;
+			}
+		};
+
+		// Nodes of one level never parent each other, and the levels above are final by the time a level runs
+		for (size_t level = 0; level + 1 < m_LevelOffsets.size(); level++)
+			ForRange(jobSystem, m_LevelOffsets[level], m_LevelOffsets[level + 1], applyParents);
+
+		// Nodes created since the last rebuild are roots appended past the last level
+		ForRange(jobSystem, m_LevelOffsets.empty() ? 0 : m_LevelOffsets.back(), count, applyParents);
+
+		m_HasDirty = false;
+	}
+
+	void TransformHierarchy::Rebuild()
+	{
+		static constexpr uint32_t UNKNOWN_DEPTH = UINT32_MAX;
+
+		const size_t count = m_IDs.size();
+		std::vector<uint32_t> depths(count, UNKNOWN_DEPTH);
+		uint32_t maxDepth = 0;
+
+		for (uint32_t i = 0; i < (uint32_t)count; i++)
+		{
+			if ((m_Flags[i] & DESTROYED) || depths[i] != UNKNOWN_DEPTH)
+				continue;
+
+			// Climb until a node with a known depth, then assign depths on the way back down
+			m_Chain.clear();
+			uint32_t node = i;
+			while (node != INVALID_INDEX && depths[node] == UNKNOWN_DEPTH)
+			{
+				m_Chain.push_back(node);
+				node = ResolveParent(node);
+			}
+
+			uint32_t depth = node == INVALID_INDEX ? 0 : depths[node] + 1;
+			for (size_t j = m_Chain.size(); j-- > 0; depth++)
+				depths[m_Chain[j]] = depth;
+			maxDepth = std::max(maxDepth, depth - 1);
+		}
+
+		// Stable counting sort by depth, dropping destroyed nodes
+		std::vector<uint32_t> offsets(maxDepth + 2, 0);
+		for (size_t i = 0; i < count; i++)
+		{
+			if (!(m_Flags[i] & DESTROYED))
+				offsets[depths[i] + 1]++;
+		}
+		for (size_t i = 1; i < offsets.size(); i++)
+			offsets[i] += offsets[i - 1];
+		m_LevelOffsets = offsets;
+
+		std::vector<uint32_t> order(count - m_DestroyedCount);
+		std::vector<uint32_t> oldToNew(count, INVALID_INDEX);
+		for (uint32_t i = 0; i < (uint32_t)count; i++)
+		{
+			if (m_Flags[i] & DESTROYED)
+				continue;
+
+			const uint32_t newIndex = offsets[depths[i]]++;
+			order[newIndex] = i;
+			oldToNew[i] = newIndex;
+		}
+
+		std::vector<uint32_t> parents(order.size());
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			const uint32_t oldIndex = order[i];
+			const uint32_t oldParent = m_Parents[oldIndex];
+			const uint32_t parent = ResolveParent(oldIndex);
+			parents[i] = parent == INVALID_INDEX ? INVALID_INDEX : oldToNew[parent];
+
+			// Lost its parent, the world matrix now comes from a different ancestor
+			if (oldParent != parent)
+				m_Flags[oldIndex] |= DIRTY;
+		}
+
+		m_Parents = std::move(parents);
+		Permute(m_IDs, order);
+		Permute(m_Positions, order);
+		Permute(m_Rotations, order);
+		Permute(m_Scales, order);
+		Permute(m_WorldMatrices, order);
+		Permute(m_InverseWorldMatrices, order);
+		Permute(m_Flags, order);
+
+		for (uint32_t i = 0; i < (uint32_t)m_IDs.size(); i++)
+			m_IDToIndex[m_IDs[i]] = i;
+
+		m_DestroyedCount = 0;
+		m_IsOrderDirty = false;
+	}
+}
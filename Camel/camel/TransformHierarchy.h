@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Core.h"
+#include "TransformMath.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+
+namespace Camel
+{
+	class JobSystem;
+
+	// Owns every transform node in structure-of-arrays form, kept sorted so parents precede their children.
+	// Nodes are addressed by stable ids, the dense index of a node changes whenever the order is rebuilt.
+	// Main thread only, reads of edited nodes update shared caches. Values are returned by copy since the storage
+	// grows on Create and is reordered by Update.
+	class TransformHierarchy final
+	{
+	public:
+		static constexpr uint32_t INVALID_ID = UINT32_MAX;
+
+		static TransformHierarchy& GetInstance()
+		{
+			static TransformHierarchy instance;
+			return instance;
+		}
+
+		TransformHierarchy(const TransformHierarchy&) = delete;
+		TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+		TransformHierarchy(TransformHierarchy&&) = delete;
+		TransformHierarchy& operator=(TransformHierarchy&&) = delete;
+
+		uint32_t Create(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+		void Destroy(const uint32_t id);
+
+		// Children keep their local position, rotation and scale relative to the new parent
+		void SetParent(const uint32_t id, const uint32_t parentID);
+		inline uint32_t GetParent(const uint32_t id) const noexcept
+		{
+			const uint32_t parent = ResolveParent(m_IDToIndex[id]);
+			return parent == INVALID_INDEX ? INVALID_ID : m_IDs[parent];
+		}
+
+		inline glm::vec3 GetPosition(const uint32_t id) const noexcept { return m_Positions[m_IDToIndex[id]]; }
+		inline void SetPosition(const uint32_t id, const glm::vec3& position) noexcept
+		{
+			const uint32_t index = m_IDToIndex[id];
+			m_Positions[index] = position;
+			MarkDirty(index);
+		}
+
+		inline glm::quat GetRotation(const uint32_t id) const noexcept { return m_Rotations[m_IDToIndex[id]]; }
+		inline void SetRotation(const uint32_t id, const glm::quat& rotation) noexcept
+		{
+			const uint32_t index = m_IDToIndex[id];
+			m_Rotations[index] = rotation;
+			MarkDirty(index);
+		}
+
+		inline glm::vec3 GetScale(const uint32_t id) const noexcept { return m_Scales[m_IDToIndex[id]]; }
+		inline void SetScale(const uint32_t id, const glm::vec3& scale) noexcept
+		{
+			const uint32_t index = m_IDToIndex[id];
+			m_Scales[index] = scale;
+			MarkDirty(index);
+		}
+
+		// Cached after Update(), nodes edited since then are recomputed through their ancestor chain on access
+		glm::mat4 GetWorldMatrix(const uint32_t id);
+		glm::mat4 GetInverseWorldMatrix(const uint32_t id);
+
+		// Compacts and re-sorts the storage when the structure changed, then recomputes every dirty subtree one depth level at a time.
+		// Nodes of a level are spread over the job system when one is given
+		void Update(JobSystem* jobSystem = nullptr);
+
+		inline size_t GetCount() const noexcept { return m_IDs.size() - m_DestroyedCount; }
+
+	private:
+		static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+		enum NodeFlags : uint8_t
+		{
+			DIRTY = 1 << 0, // Local values changed, the world matrix of the node and its subtree is stale
+			INVERSE_STALE = 1 << 1, // World matrix changed since the inverse was last computed
+			DESTROYED = 1 << 2,
+		};
+
+		TransformHierarchy() = default;
+		~TransformHierarchy() = default;
+
+		inline void MarkDirty(const uint32_t index) noexcept
+		{
+			m_Flags[index] |= DIRTY;
+			m_HasDirty = true;
+		}
+
+		// Skips destroyed ancestors, which stay in place until the next rebuild
+		inline uint32_t ResolveParent(uint32_t index) const noexcept
+		{
+			uint32_t parent = m_Parents[index];
+			while (parent != INVALID_INDEX && (m_Flags[parent] & DESTROYED))
+				parent = m_Parents[parent];
+			return parent;
+		}
+
+		inline glm::mat4 CalculateLocalMatrix(const uint32_t index) const noexcept
+		{
+			glm::mat4 matrix;
+			TransformMath::ComposeTRS(&m_Positions[index], &m_Rotations[index], &m_Scales[index], &matrix, 1);
+			return matrix;
+		}
+
+		void Rebuild();
+
+	private:
+		// Indexed by dense index, sorted by depth
+		std::vector<uint32_t> m_IDs;
+		std::vector<uint32_t> m_Parents;
+		std::vector<glm::vec3> m_Positions;
+		std::vector<glm::quat> m_Rotations;
+		std::vector<glm::vec3> m_Scales;
+		std::vector<glm::mat4> m_WorldMatrices;
+		std::vector<glm::mat4> m_InverseWorldMatrices;
+		std::vector<uint8_t> m_Flags;
+
+		// First dense index of every depth level as of the last rebuild, plus the end of the last level
+		std::vector<uint32_t> m_LevelOffsets;
+
+		// Indexed by id
+		std::vector<uint32_t> m_IDToIndex;
+		std::vector<uint32_t> m_FreeIDs;
+
+		std::vector<uint32_t> m_Chain; // Scratch ancestor chain for on-demand evaluation
+
+		size_t m_DestroyedCount = 0;
+		bool m_IsOrderDirty = false;
+		bool m_HasDirty = false;
+	};
+}
@@ -0,0 +1,156 @@
+#include "TransformMath.h"
+
+#ifdef CAMEL_SIMD_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace Camel
+{
+	namespace
+	{
+		inline void ComposeTRSScalar(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, glm::mat4& matrix) noexcept
+		{
+			const float xx = rotation.x * rotation.x, yy = rotation.y * rotation.y, zz = rotation.z * rotation.z;
+			const float xy = rotation.x * rotation.y, xz = rotation.x * rotation.z, yz = rotation.y * rotation.z;
+			const float wx = rotation.w * rotation.x, wy = rotation.w * rotation.y, wz = rotation.w * rotation.z;
+
+			matrix[0] = glm::vec4(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f) * scale.x;
+			matrix[1] = glm::vec4(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f) * scale.y;
+			matrix[2] = glm::vec4(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f) * scale.z;
+			matrix[3] = glm::vec4(position, 1.0f);
+		}
+
+#ifdef CAMEL_SIMD_SSE
+		// Writes one column of four matrices from lanes holding that column's x, y, z and w for each matrix
+		inline void StoreColumn(__m128 x, __m128 y, __m128 z, __m128 w, glm::mat4* matrices, const int column) noexcept
+		{
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			_mm_storeu_ps(&matrices[0][column][0], x);
+			_mm_storeu_ps(&matrices[1][column][0], y);
+			_mm_storeu_ps(&matrices[2][column][0], z);
+			_mm_storeu_ps(&matrices[3][column][0], w);
+		}
+#endif
+	}
+
+	void TransformMath::ComposeTRS(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, glm::mat4* matrices, const size_t count) noexcept
+	{
+		size_t i = 0;
+
+#ifdef CAMEL_SIMD_SSE
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 two = _mm_set1_ps(2.0f);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			// Quaternions are stored x, y, z, w so a transpose gives one component per register
+			__m128 qx = _mm_loadu_ps(&rotations[i + 0][0]);
+			__m128 qy = _mm_loadu_ps(&rotations[i + 1][0]);
+			__m128 qz = _mm_loadu_ps(&rotations[i + 2][0]);
+			__m128 qw = _mm_loadu_ps(&rotations[i + 3][0]);
+			_MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+
+			const __m128 sx = _mm_setr_ps(scales[i].x, scales[i + 1].x, scales[i + 2].x, scales[i + 3].x);
+			const __m128 sy = _mm_setr_ps(scales[i].y, scales[i + 1].y, scales[i + 2].y, scales[i + 3].y);
+			const __m128 sz = _mm_setr_ps(scales[i].z, scales[i + 1].z, scales[i + 2].z, scales[i + 3].z);
+
+			const __m128 x2 = _mm_mul_ps(qx, two), y2 = _mm_mul_ps(qy, two), z2 = _mm_mul_ps(qz, two);
+			const __m128 xx = _mm_mul_ps(qx, x2), yy = _mm_mul_ps(qy, y2), zz = _mm_mul_ps(qz, z2);
+			const __m128 xy = _mm_mul_ps(qx, y2), xz = _mm_mul_ps(qx, z2), yz = _mm_mul_ps(qy, z2);
+			const __m128 wx = _mm_mul_ps(qw, x2), wy = _mm_mul_ps(qw, y2), wz = _mm_mul_ps(qw, z2);
+
+			StoreColumn(
+				_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx),
+				_mm_mul_ps(_mm_add_ps(xy, wz), sx),
+				_mm_mul_ps(_mm_sub_ps(xz, wy), sx),
+				zero, matrices + i, 0);
+
+			StoreColumn(
+				_mm_mul_ps(_mm_sub_ps(xy, wz), sy),
+				_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy),
+				_mm_mul_ps(_mm_add_ps(yz, wx), sy),
+				zero, matrices + i, 1);
+
+			StoreColumn(
+				_mm_mul_ps(_mm_add_ps(xz, wy), sz),
+				_mm_mul_ps(_mm_sub_ps(yz, wx), sz),
+				_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz),
+				zero, matrices + i, 2);
+
+			StoreColumn(
+				_mm_setr_ps(positions[i].x, positions[i + 1].x, positions[i + 2].x, positions[i + 3].x),
+				_mm_setr_ps(positions[i].y, positions[i + 1].y, positions[i + 2].y, positions[i + 3].y),
+				_mm_setr_ps(positions[i].z, positions[i + 1].z, positions[i + 2].z, positions[i + 3].z),
+				one, matrices + i, 3);
+		}
+#endif
+
+		for (; i < count; i++)
+			ComposeTRSScalar(positions[i], rotations[i], scales[i], matrices[i]);
+	}
+
+	void TransformMath::MultiplyAffine(const glm::mat4& left, const glm::mat4& right, glm::mat4& result) noexcept
+	{
+#ifdef CAMEL_SIMD_SSE
+		const __m128 l0 = _mm_loadu_ps(&left[0][0]);
+		const __m128 l1 = _mm_loadu_ps(&left[1][0]);
+		const __m128 l2 = _mm_loadu_ps(&left[2][0]);
+		const __m128 l3 = _mm_loadu_ps(&left[3][0]);
+
+		for (int column = 0; column < 3; column++)
+		{
+			const __m128 r = _mm_loadu_ps(&right[column][0]);
+			__m128 sum = _mm_mul_ps(l0, _mm_shuffle_ps(r, r, _MM_SHUFFLE(0, 0, 0, 0)));
+			sum = _mm_add_ps(sum, _mm_mul_ps(l1, _mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 1, 1, 1))));
+			sum = _mm_add_ps(sum, _mm_mul_ps(l2, _mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 2, 2, 2))));
+			_mm_storeu_ps(&result[column][0], sum);
+		}
+
+		const __m128 r = _mm_loadu_ps(&right[3][0]);
+		__m128 sum = _mm_add_ps(l3, _mm_mul_ps(l0, _mm_shuffle_ps(r, r, _MM_SHUFFLE(0, 0, 0, 0))));
+		sum = _mm_add_ps(sum, _mm_mul_ps(l1, _mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 1, 1, 1))));
+		sum = _mm_add_ps(sum, _mm_mul_ps(l2, _mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 2, 2, 2))));
+		_mm_storeu_ps(&result[3][0], sum);
+#else
+		glm::mat4 product;
+		for (int column = 0; column < 3; column++)
+			product[column] = left[0] * right[column].x + left[1] * right[column].y + left[2] * right[column].z;
+		product[3] = left[0] * right[3].x + left[1] * right[3].y + left[2] * right[3].z + left[3];
+		result = product;
+#endif
+	}
+
+	glm::mat4 TransformMath::InverseTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) noexcept
+	{
+		// (T * R * S)^-1 = S^-1 * R^T * T^-1
+		const glm::mat3 rotationMatrix = glm::mat3_cast(rotation);
+		const glm::vec3 inverseScale = 1.0f / scale;
+
+		glm::mat4 inverse(1.0f);
+		for (int column = 0; column < 3; column++)
+		{
+			for (int row = 0; row < 3; row++)
+				inverse[column][row] = rotationMatrix[row][column] * inverseScale[row];
+		}
+		inverse[3] = glm::vec4(-(glm::mat3(inverse) * position), 1.0f);
+		return inverse;
+	}
+
+	glm::mat4 TransformMath::InverseAffine(const glm::mat4& matrix) noexcept
+	{
+		// The rows of the inverse 3x3 are the cross products of the columns over the determinant
+		const glm::vec3 c0(matrix[0]), c1(matrix[1]), c2(matrix[2]);
+		const glm::vec3 r0 = glm::cross(c1, c2);
+		const glm::vec3 r1 = glm::cross(c2, c0);
+		const glm::vec3 r2 = glm::cross(c0, c1);
+		const float inverseDeterminant = 1.0f / glm::dot(c0, r0);
+
+		glm::mat4 inverse(1.0f);
+		inverse[0] = glm::vec4(r0.x, r1.x, r2.x, 0.0f) * inverseDeterminant;
+		inverse[1] = glm::vec4(r0.y, r1.y, r2.y, 0.0f) * inverseDeterminant;
+		inverse[2] = glm::vec4(r0.z, r1.z, r2.z, 0.0f) * inverseDeterminant;
+		inverse[3] = glm::vec4(-(glm::mat3(inverse) * glm::vec3(matrix[3])), 1.0f);
+		return inverse;
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Core.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+namespace Camel
+{
+	// Matrix kernels for translation-rotation-scale transforms, vectorized with SSE where available
+	class TransformMath final
+	{
+	public:
+		// Builds translate * rotate * scale for count transforms, four at a time
+		static void ComposeTRS(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, glm::mat4* matrices, const size_t count) noexcept;
+
+		// Product of two affine matrices, result may alias either operand
+		static void MultiplyAffine(const glm::mat4& left, const glm::mat4& right, glm::mat4& result) noexcept;
+
+		// Closed-form inverse of translate * rotate * scale, scale must be non-zero
+		static glm::mat4 InverseTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) noexcept;
+
+		// Inverse of any matrix whose last row is (0, 0, 0, 1), such as a chain of TRS products
+		static glm::mat4 InverseAffine(const glm::mat4& matrix) noexcept;
+
+	public:
+		TransformMath() = delete;
+	};
+}
@@ -0,0 +1,50 @@
+#include "UniformBuffer.h"
+
+namespace Camel
+{
+	UniformBuffer::UniformBuffer(const size_t size, const GLuint binding)
+		: m_UBO(0), m_Binding(binding), m_Size(size)
+	{
+		glGenBuffers(1, &m_UBO);
+		GLState::BindBuffer(GL_UNIFORM_BUFFER, m_UBO);
+		glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+		GLState::BindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	UniformBuffer::UniformBuffer(UniformBuffer&& other) noexcept
+		: m_UBO(other.m_UBO), m_Binding(other.m_Binding), m_Size(other.m_Size)
+	{
+		other.m_UBO = 0;
+		other.m_Size = 0;
+	}
+
+	UniformBuffer& UniformBuffer::operator=(UniformBuffer&& other) noexcept
+	{
+		if (this != &other)
+		{
+			GLState::DeleteBuffer(m_UBO);
+
+			m_UBO = other.m_UBO;
+			m_Binding = other.m_Binding;
+			m_Size = other.m_Size;
+
+			other.m_UBO = 0;
+			other.m_Size = 0;
+		}
+		return *this;
+	}
+
+	UniformBuffer::~UniformBuffer() noexcept
+	{
+		GLState::DeleteBuffer(m_UBO);
+	}
+
+	void UniformBuffer::Update(const void* data, const size_t size)
+	{
+		CAMEL_ASSERT(size <= m_Size, "Uniform buffer update of {} bytes exceeds its {} bytes", size, m_Size);
+
+		GLState::BindBuffer(GL_UNIFORM_BUFFER, m_UBO);
+		glBufferData(GL_UNIFORM_BUFFER, m_Size, nullptr, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+	}
+}
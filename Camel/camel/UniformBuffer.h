@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Core.h"
+#include "GLState.h"
+
+#include <cstddef>
+#include <string_view>
+
+namespace Camel
+{
+	// Fixed binding points of the uniform blocks shared by every shader
+	constexpr GLuint CAMERA_BLOCK_BINDING = 0;
+	constexpr GLuint LIGHTS_BLOCK_BINDING = 1;
+
+	// std140 layout of the Camera block:
+	// layout(std140) uniform Camera { mat4 u_View; mat4 u_Projection; mat4 u_ViewProjection; vec3 u_ViewPos; };
+	struct CameraBlock
+	{
+		glm::mat4 view = glm::mat4(1.0f);
+		glm::mat4 projection = glm::mat4(1.0f);
+		glm::mat4 viewProjection = glm::mat4(1.0f);
+		alignas(16) glm::vec3 position = glm::vec3(0.0f);
+	};
+
+	// std140 layout of the Lights block:
+	// layout(std140) uniform Lights { vec3 u_LightPos; vec3 u_LightColor; vec3 u_SkyColor; vec3 u_GroundColor; };
+	struct LightsBlock
+	{
+		alignas(16) glm::vec3 position = glm::vec3(0.0f);
+		alignas(16) glm::vec3 color = glm::vec3(0.0f);
+		alignas(16) glm::vec3 skyColor = glm::vec3(0.0f);
+		alignas(16) glm::vec3 groundColor = glm::vec3(0.0f);
+	};
+
+	static_assert(offsetof(CameraBlock, position) == 192 && sizeof(CameraBlock) == 208, "CameraBlock must match std140");
+	static_assert(offsetof(LightsBlock, groundColor) == 48 && sizeof(LightsBlock) == 64, "LightsBlock must match std140");
+
+	// Blocks Shader binds by name after linking
+	struct UniformBlockInfo
+	{
+		std::string_view name;
+		GLuint binding;
+		size_t size;
+	};
+
+	constexpr UniformBlockInfo UNIFORM_BLOCKS[] =
+	{
+		{ "Camera", CAMERA_BLOCK_BINDING, sizeof(CameraBlock) },
+		{ "Lights", LIGHTS_BLOCK_BINDING, sizeof(LightsBlock) },
+	};
+
+	// GPU buffer backing one uniform block, bound to a fixed binding point
+	class UniformBuffer final
+	{
+	public:
+		UniformBuffer(const size_t size, const GLuint binding);
+
+		UniformBuffer(const UniformBuffer&) = delete;
+		UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+		UniformBuffer(UniformBuffer&& other) noexcept;
+		UniformBuffer& operator=(UniformBuffer&& other) noexcept;
+
+		~UniformBuffer() noexcept;
+
+		// Replaces the contents, orphaning the storage so draws of the previous frame do not stall the upload
+		void Update(const void* data, const size_t size);
+
+		template<typename T>
+		inline void Update(const T& block)
+		{
+			Update(&block, sizeof(T));
+		}
+
+		// Binds the buffer to its binding point, every program with a block at that point reads it
+		inline void Bind() const noexcept
+		{
+			GLState::BindBufferBase(GL_UNIFORM_BUFFER, m_Binding, m_UBO);
+		}
+
+		inline GLuint GetBinding() const noexcept { return m_Binding; }
+		inline size_t GetSize() const noexcept { return m_Size; }
+
+	private:
+		GLuint m_UBO;
+		GLuint m_Binding;
+		size_t m_Size;
+	};
+}
@@ -0,0 +1,93 @@
+#include "VertexLayout.h"
+
+#include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+
+namespace Camel
+{
+	namespace
+	{
+		struct CompactVertex
+		{
+			uint16_t position[4]; // xyz unorm16, w unused padding
+			uint32_t normal; // snorm 2_10_10_10
+			uint32_t texcoord; // 2 half floats
+		};
+
+		static_assert(sizeof(CompactVertex) == 16, "CompactVertex must stay tightly packed");
+	}
+
+	const VertexLayout& VertexLayout::Get(const VertexFormat format) noexcept
+	{
+		static const VertexLayout standard(
+			{
+				{ POSITION_ATTRIBUTE_LOCATION, 3, GL_FLOAT, GL_FALSE, (GLuint)offsetof(Vertex, position) },
+				{ NORMAL_ATTRIBUTE_LOCATION, 3, GL_FLOAT, GL_FALSE, (GLuint)offsetof(Vertex, normal) },
+				{ TEXCOORD_ATTRIBUTE_LOCATION, 2, GL_FLOAT, GL_FALSE, (GLuint)offsetof(Vertex, texcoord) },
+			}, sizeof(Vertex));
+
+		static const VertexLayout compact(
+			{
+				{ POSITION_ATTRIBUTE_LOCATION, 3, GL_UNSIGNED_SHORT, GL_TRUE, (GLuint)offsetof(CompactVertex, position) },
+				{ NORMAL_ATTRIBUTE_LOCATION, 4, GL_INT_2_10_10_10_REV, GL_TRUE, (GLuint)offsetof(CompactVertex, normal) },
+				{ TEXCOORD_ATTRIBUTE_LOCATION, 2, GL_HALF_FLOAT, GL_FALSE, (GLuint)offsetof(CompactVertex, texcoord) },
+			}, sizeof(CompactVertex));
+
+		switch (format)
+		{
+		case VertexFormat::COMPACT:
+			return compact;
+		case VertexFormat::STANDARD:
+		default:
+			return standard;
+		}
+	}
+
+	PackedVertices VertexLayout::Pack(const std::vector<Vertex>& vertices, const VertexFormat format, const Bounds& bounds)
+	{
+		PackedVertices packed;
+		packed.dequantize = glm::mat4(1.0f);
+
+		if (format == VertexFormat::STANDARD)
+		{
+			packed.data.resize(vertices.size() * sizeof(Vertex));
+			std::memcpy(packed.data.data(), vertices.data(), packed.data.size());
+			return packed;
+		}
+
+		// Positions are stored as fractions of the bounding box, flat axes keep a unit scale to avoid dividing by zero
+		glm::vec3 extents = bounds.max - bounds.min;
+		for (int axis = 0; axis < 3; axis++)
+			if (extents[axis] <= 0.0f)
+				extents[axis] = 1.0f;
+
+		packed.dequantize = glm::scale(glm::translate(glm::mat4(1.0f), bounds.min), extents);
+		packed.data.resize(vertices.size() * sizeof(CompactVertex));
+
+		CompactVertex* output = reinterpret_cast<CompactVertex*>(packed.data.data());
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			const Vertex& vertex = vertices[i];
+			const glm::vec3 position = glm::clamp((vertex.position - bounds.min) / extents, 0.0f, 1.0f);
+
+			for (int axis = 0; axis < 3; axis++)
+				output[i].position[axis] = (uint16_t)std::lround(position[axis] * 65535.0f);
+			output[i].position[3] = 0;
+
+			output[i].normal = glm::packSnorm3x10_1x2(glm::vec4(vertex.normal, 0.0f));
+			output[i].texcoord = glm::packHalf2x16(vertex.texcoord);
+		}
+
+		return packed;
+	}
+
+	void VertexLayout::Apply(const GLintptr baseOffset) const noexcept
+	{
+		for (const VertexAttribute& attribute : m_Attributes)
+		{
+			glVertexAttribPointer(attribute.location, attribute.componentCount, attribute.type, attribute.normalized, m_Stride, (const void*)(baseOffset + attribute.offset));
+			glEnableVertexAttribArray(attribute.location);
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Core.h"
+#include "Bounds.h"
+
+#include <vector>
+
+namespace Camel
+{
+	// Full precision vertex produced by the importers, packed into a VertexFormat on upload
+	struct Vertex
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 texcoord;
+	};
+
+	// Attribute locations every vertex layout and shader agree on
+	enum VertexAttributeLocation : GLuint
+	{
+		POSITION_ATTRIBUTE_LOCATION = 0,
+		NORMAL_ATTRIBUTE_LOCATION = 1,
+		TEXCOORD_ATTRIBUTE_LOCATION = 2,
+		INSTANCE_MODEL_ATTRIBUTE_LOCATION = 3, // mat4, one column per location up to 6
+		INSTANCE_COLOR_ATTRIBUTE_LOCATION = 7,
+	};
+
+	enum class VertexFormat
+	{
+		STANDARD, // 32 bytes: float position, normal and texcoord
+		COMPACT, // 16 bytes: unorm16 position (dequantized through the mesh bounds), 2_10_10_10 normal, half float texcoord
+	};
+
+	struct VertexAttribute
+	{
+		GLuint location;
+		GLint componentCount;
+		GLenum type;
+		GLboolean normalized;
+		GLuint offset;
+
+		bool operator==(const VertexAttribute&) const = default;
+	};
+
+	// Vertex data converted to a VertexFormat
+	struct PackedVertices
+	{
+		std::vector<uint8_t> data;
+		glm::mat4 dequantize; // Maps stored positions back to model space
+	};
+
+	// Describes how interleaved vertex data maps onto shader attributes
+	class VertexLayout final
+	{
+	public:
+		static const VertexLayout& Get(const VertexFormat format) noexcept;
+
+		static PackedVertices Pack(const std::vector<Vertex>& vertices, const VertexFormat format, const Bounds& bounds);
+
+	public:
+		VertexLayout(std::vector<VertexAttribute> attributes, const GLsizei stride)
+			: m_Attributes(std::move(attributes)), m_Stride(stride)
+		{}
+
+		// Points the attributes at the currently bound GL_ARRAY_BUFFER, starting baseOffset bytes in
+		void Apply(const GLintptr baseOffset = 0) const noexcept;
+
+		inline const std::vector<VertexAttribute>& GetAttributes() const noexcept { return m_Attributes; }
+		inline GLsizei GetStride() const noexcept { return m_Stride; }
+
+		bool operator==(const VertexLayout&) const = default;
+
+	private:
+		std::vector<VertexAttribute> m_Attributes;
+		GLsizei m_Stride;
+	};
+}
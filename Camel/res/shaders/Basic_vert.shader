@@ -3,10 +3,16 @@
 layout(location = 0) in vec3 a_Position;
 
 uniform mat4 u_Model;
-uniform mat4 u_View;
-uniform mat4 u_Projection;
+
+layout(std140) uniform Camera
+{
+	mat4 u_View;
+	mat4 u_Projection;
+	mat4 u_ViewProjection;
+	vec3 u_ViewPos;
+};
 
 void main()
 {
-	gl_Position = u_Projection * u_View * u_Model * vec4(a_Position, 1.0);
+	gl_Position = u_ViewProjection * u_Model * vec4(a_Position, 1.0);
 }
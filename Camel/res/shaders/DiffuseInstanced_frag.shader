@@ -0,0 +1,53 @@
+#version 330 core
+
+in vec3 v_FragPos;
+in vec3 v_Normal;
+in vec2 v_TexCoord;
+in vec4 v_Color;
+
+out vec4 o_Color;
+
+uniform sampler2D u_DiffuseImage;
+
+layout(std140) uniform Camera
+{
+	mat4 u_View;
+	mat4 u_Projection;
+	mat4 u_ViewProjection;
+	vec3 u_ViewPos;
+};
+
+layout(std140) uniform Lights
+{
+	vec3 u_LightPos;
+	vec3 u_LightColor;
+	vec3 u_SkyColor;
+	vec3 u_GroundColor;
+};
+
+void main()
+{
+	vec3 baseColor = v_Color.rgb;
+	vec3 normal = normalize(v_Normal);
+
+	// ambient
+	float ambientStrength = 0.2;
+	float h = 0.5 * normal.y + 0.5;
+	vec3 ambient = h * u_SkyColor + (1.0 - h) * u_GroundColor;
+	ambient *= ambientStrength * baseColor;
+
+	// diffuse
+	vec3 lightDir = normalize(u_LightPos - v_FragPos);
+	float diff = max(dot(lightDir, normal), 0.1);
+	vec3 diffuse = diff * u_LightColor * baseColor;
+
+	// specular
+	float specularStrength = 0.2;
+	vec3 viewDir = normalize(u_ViewPos - v_FragPos);
+	vec3 reflectDir = reflect(-lightDir, normal);
+	float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+	vec3 specular = specularStrength * spec * u_LightColor;
+
+	vec4 texColor = texture(u_DiffuseImage, v_TexCoord);
+	o_Color = vec4(ambient + (diffuse * texColor.rgb) + specular, texColor.a * v_Color.a);
+}
@@ -0,0 +1,33 @@
+#version 330 core
+
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in vec3 a_Normal;
+layout(location = 2) in vec2 a_TexCoord;
+layout(location = 3) in mat4 a_Model;
+layout(location = 7) in vec4 a_Color;
+
+out vec3 v_FragPos;
+out vec3 v_Normal;
+out vec2 v_TexCoord;
+out vec4 v_Color;
+
+uniform mat4 u_Dequantize;
+
+layout(std140) uniform Camera
+{
+	mat4 u_View;
+	mat4 u_Projection;
+	mat4 u_ViewProjection;
+	vec3 u_ViewPos;
+};
+
+void main()
+{
+	vec4 worldPos = a_Model * (u_Dequantize * vec4(a_Position, 1.0));
+	gl_Position = u_ViewProjection * worldPos;
+	v_FragPos = vec3(worldPos);
+	// Inverse transpose keeps normals perpendicular to the surface under non-uniform scale
+	v_Normal = transpose(inverse(mat3(a_Model))) * a_Normal;
+	v_TexCoord = a_TexCoord;
+	v_Color = a_Color;
+}
@@ -6,25 +6,37 @@ in vec2 v_TexCoord;
 
 out vec4 o_Color;
 
-uniform vec3 u_LightPos;
-uniform vec3 u_ViewPos;
-uniform vec3 u_LightColor;
 uniform vec3 u_BaseColor;
-uniform vec3 u_SkyColor;
-uniform vec3 u_GroundColor;
 uniform sampler2D u_DiffuseImage;
 
+layout(std140) uniform Camera
+{
+	mat4 u_View;
+	mat4 u_Projection;
+	mat4 u_ViewProjection;
+	vec3 u_ViewPos;
+};
+
+layout(std140) uniform Lights
+{
+	vec3 u_LightPos;
+	vec3 u_LightColor;
+	vec3 u_SkyColor;
+	vec3 u_GroundColor;
+};
+
 void main()
 {
+	vec3 normal = normalize(v_Normal);
+
 	// ambient
 	float ambientStrength = 0.2;
-	float h = 0.5 * v_Normal.y + 0.5;
+	float h = 0.5 * normal.y + 0.5;
 	vec3 ambient = h * u_SkyColor + (1.0 - h) * u_GroundColor;
 	ambient *= ambientStrength * u_BaseColor;
 
 	// diffuse
 	vec3 lightDir = normalize(u_LightPos - v_FragPos);
-	vec3 normal = normalize(v_Normal);
 	float diff = max(dot(lightDir, normal), 0.1);
 	vec3 diffuse = diff * u_LightColor * u_BaseColor;
 
@@ -9,13 +9,21 @@ out vec3 v_Normal;
 out vec2 v_TexCoord;
 
 uniform mat4 u_Model;
-uniform mat4 u_View;
-uniform mat4 u_Projection;
+uniform mat3 u_NormalMatrix; // Inverse transpose of the model matrix, without dequantization
+
+layout(std140) uniform Camera
+{
+	mat4 u_View;
+	mat4 u_Projection;
+	mat4 u_ViewProjection;
+	vec3 u_ViewPos;
+};
 
 void main()
 {
-	gl_Position = u_Projection * u_View * u_Model * vec4(a_Position, 1.0);
-	v_FragPos = vec3(u_Model * vec4(a_Position, 1.0));
-	v_Normal = a_Normal;
+	vec4 worldPos = u_Model * vec4(a_Position, 1.0);
+	gl_Position = u_ViewProjection * worldPos;
+	v_FragPos = vec3(worldPos);
+	v_Normal = u_NormalMatrix * a_Normal;
 	v_TexCoord = a_TexCoord;
 }
@@ -0,0 +1,297 @@
+// Mesh import benchmark. Generates synthetic obj files and times every import stage separately.
+//
+// Usage: CamelBench [--triangles 10000,100000,1000000] [--iterations 3] [--threads 0] [--output bench.json] [--work-dir bench_data] [--no-upload]
+//
+// Each stage reports the fastest of the iterations, peak memory is the process peak after the case ran
+// (cases run from small to large so it is dominated by the current case).
+
+#include "ObjGenerator.h"
+#include "camel/Core.h"
+#include "camel/Mesh.h"
+#include "camel/MeshOptimizer.h"
+#include "camel/ObjParser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+#pragma comment(lib, "Psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace Camel;
+
+namespace
+{
+	struct BenchSettings
+	{
+		std::vector<size_t> triangleCounts = { 10000, 100000, 1000000 };
+		unsigned int iterations = 3;
+		unsigned int threadCount = 0;
+		std::string outputPath = "bench.json";
+		std::string workDirectory = "bench_data";
+		bool upload = true;
+	};
+
+	struct BenchResult
+	{
+		std::string shape;
+		size_t requestedTriangles = 0;
+		size_t fileBytes = 0;
+		size_t vertexCount = 0;
+		size_t triangleCount = 0;
+
+		double parseSeconds = std::numeric_limits<double>::max();
+		double deduplicateSeconds = std::numeric_limits<double>::max();
+		double optimizeSeconds = std::numeric_limits<double>::max();
+		double uploadSeconds = -1.0; // Negative when no GL context was available
+
+		size_t peakMemoryBytes = 0;
+	};
+
+	size_t GetPeakMemoryBytes()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return counters.PeakWorkingSetSize;
+		return 0;
+#else
+		rusage usage{};
+		getrusage(RUSAGE_SELF, &usage);
+		return (size_t)usage.ru_maxrss * 1024; // Kilobytes on Linux
+#endif
+	}
+
+	template<typename Func>
+	double Measure(Func&& func)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		func();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	std::vector<size_t> ParseCounts(const std::string& text)
+	{
+		std::vector<size_t> counts;
+		size_t start = 0;
+		while (start < text.size())
+		{
+			const size_t comma = std::min(text.find(',', start), text.size());
+			counts.push_back(std::stoull(text.substr(start, comma - start)));
+			start = comma + 1;
+		}
+		return counts;
+	}
+
+	BenchSettings ParseArguments(int argc, char* argv[])
+	{
+		BenchSettings settings;
+		for (int i = 1; i < argc; i++)
+		{
+			const std::string argument = argv[i];
+			const bool hasValue = i + 1 < argc;
+
+			if (argument == "--triangles" && hasValue)
+				settings.triangleCounts = ParseCounts(argv[++i]);
+			else if (argument == "--iterations" && hasValue)
+				settings.iterations = std::max(1, std::stoi(argv[++i]));
+			else if (argument == "--threads" && hasValue)
+				settings.threadCount = (unsigned int)std::stoul(argv[++i]);
+			else if (argument == "--output" && hasValue)
+				settings.outputPath = argv[++i];
+			else if (argument == "--work-dir" && hasValue)
+				settings.workDirectory = argv[++i];
+			else if (argument == "--no-upload")
+				settings.upload = false;
+			else
+				throw std::runtime_error("Unknown or incomplete argument " + argument);
+		}
+
+		std::sort(settings.triangleCounts.begin(), settings.triangleCounts.end());
+		return settings;
+	}
+
+	// Hidden window with the same context the engine creates, only needed to time uploads
+	class HiddenContext final
+	{
+	public:
+		HiddenContext()
+			: m_Window(nullptr), m_Context(nullptr)
+		{
+			if (SDL_Init(SDL_INIT_VIDEO) != 0)
+				return;
+
+			SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+			SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+			SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+
+			m_Window = SDL_CreateWindow("CamelBench", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 64, 64, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+			if (m_Window)
+				m_Context = SDL_GL_CreateContext(m_Window);
+
+			if (m_Context && glewInit() != GLEW_OK)
+			{
+				SDL_GL_DeleteContext(m_Context);
+				m_Context = nullptr;
+			}
+		}
+
+		HiddenContext(const HiddenContext&) = delete;
+		HiddenContext& operator=(const HiddenContext&) = delete;
+
+		~HiddenContext()
+		{
+			if (m_Context)
+				SDL_GL_DeleteContext(m_Context);
+			if (m_Window)
+				SDL_DestroyWindow(m_Window);
+			SDL_Quit();
+		}
+
+		inline bool IsValid() const noexcept { return m_Context != nullptr; }
+
+	private:
+		SDL_Window* m_Window;
+		SDL_GLContext m_Context;
+	};
+
+	BenchResult RunCase(const BenchSettings& settings, const ObjShape shape, const size_t triangleCount, const bool upload)
+	{
+		BenchResult result;
+		result.shape = ObjGenerator::GetShapeName(shape);
+		result.requestedTriangles = triangleCount;
+
+		const std::string filePath = (std::filesystem::path(settings.workDirectory) / (result.shape + "_" + std::to_string(triangleCount) + ".obj")).string();
+		result.fileBytes = ObjGenerator::Generate(filePath, shape, triangleCount);
+
+		for (unsigned int iteration = 0; iteration < settings.iterations; iteration++)
+		{
+			ObjParseTimings timings{};
+			MeshData data = ObjParser::ParseFile(filePath, settings.threadCount, &timings);
+			result.parseSeconds = std::min(result.parseSeconds, timings.parseSeconds);
+			result.deduplicateSeconds = std::min(result.deduplicateSeconds, timings.deduplicateSeconds);
+			result.vertexCount = data.vertices.size();
+			result.triangleCount = data.indices.size() / 3;
+
+			result.optimizeSeconds = std::min(result.optimizeSeconds, Measure([&data]() { MeshOptimizer::Optimize(data); }));
+
+			if (upload)
+			{
+				// glFinish so the time covers the transfer, not just queuing it
+				const double uploadSeconds = Measure([&data]()
+				{
+					Mesh mesh(data.vertices, data.indices);
+					glFinish();
+				});
+				result.uploadSeconds = result.uploadSeconds < 0.0 ? uploadSeconds : std::min(result.uploadSeconds, uploadSeconds);
+			}
+		}
+
+		result.peakMemoryBytes = GetPeakMemoryBytes();
+		return result;
+	}
+
+	void WriteResults(const BenchSettings& settings, const std::vector<BenchResult>& results)
+	{
+		std::ofstream file(settings.outputPath, std::ios::trunc);
+		if (!file)
+			throw std::runtime_error("Failed to open benchmark output at path: " + settings.outputPath);
+
+#ifdef NDEBUG
+		const char* configuration = "release";
+#else
+		const char* configuration = "debug";
+#endif
+
+		const auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+		file << "{\n";
+		file << "  \"timestamp\": " << timestamp << ",\n";
+		file << "  \"configuration\": \"" << configuration << "\",\n";
+		file << "  \"iterations\": " << settings.iterations << ",\n";
+		file << "  \"threads\": " << (settings.threadCount ? settings.threadCount : std::thread::hardware_concurrency()) << ",\n";
+		file << "  \"cases\": [\n";
+
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const BenchResult& result = results[i];
+			const double importSeconds = result.parseSeconds + result.deduplicateSeconds;
+
+			file << "    {\n";
+			file << "      \"shape\": \"" << result.shape << "\",\n";
+			file << "      \"requestedTriangles\": " << result.requestedTriangles << ",\n";
+			file << "      \"fileBytes\": " << result.fileBytes << ",\n";
+			file << "      \"vertices\": " << result.vertexCount << ",\n";
+			file << "      \"triangles\": " << result.triangleCount << ",\n";
+			file << "      \"parseSeconds\": " << result.parseSeconds << ",\n";
+			file << "      \"deduplicateSeconds\": " << result.deduplicateSeconds << ",\n";
+			file << "      \"optimizeSeconds\": " << result.optimizeSeconds << ",\n";
+			if (result.uploadSeconds >= 0.0)
+				file << "      \"uploadSeconds\": " << result.uploadSeconds << ",\n";
+			else
+				file << "      \"uploadSeconds\": null,\n";
+			file << "      \"parseMegabytesPerSecond\": " << result.fileBytes / 1e6 / result.parseSeconds << ",\n";
+			file << "      \"importMegabytesPerSecond\": " << result.fileBytes / 1e6 / importSeconds << ",\n";
+			file << "      \"importTrianglesPerSecond\": " << result.triangleCount / importSeconds << ",\n";
+			file << "      \"optimizeTrianglesPerSecond\": " << result.triangleCount / result.optimizeSeconds << ",\n";
+			file << "      \"peakMemoryBytes\": " << result.peakMemoryBytes << "\n";
+			file << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+		}
+
+		file << "  ]\n";
+		file << "}\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		const BenchSettings settings = ParseArguments(argc, argv);
+		std::filesystem::create_directories(settings.workDirectory);
+
+		HiddenContext context;
+		const bool upload = settings.upload && context.IsValid();
+		if (settings.upload && !upload)
+			std::cerr << "No OpenGL context available, skipping upload timings" << std::endl;
+
+		const ObjShape shapes[] = { ObjShape::GRID, ObjShape::SPHERE, ObjShape::SPARSE_NGON, ObjShape::POSITIONS_ONLY };
+
+		std::vector<BenchResult> results;
+		for (const size_t triangleCount : settings.triangleCounts)
+		{
+			for (const ObjShape shape : shapes)
+			{
+				const BenchResult& result = results.emplace_back(RunCase(settings, shape, triangleCount, upload));
+
+				std::cout << std::format("{:>14} {:>9} tris | parse {:8.2f} ms ({:7.1f} MB/s) | dedup {:8.2f} ms | optimize {:8.2f} ms | upload {:8.2f} ms | peak {:6.1f} MB",
+					result.shape, result.triangleCount,
+					result.parseSeconds * 1e3, result.fileBytes / 1e6 / result.parseSeconds,
+					result.deduplicateSeconds * 1e3, result.optimizeSeconds * 1e3, std::max(result.uploadSeconds, 0.0) * 1e3,
+					result.peakMemoryBytes / 1e6) << std::endl;
+			}
+		}
+
+		WriteResults(settings, results);
+		std::cout << "Wrote " << results.size() << " results to " << settings.outputPath << std::endl;
+	}
+	catch (const std::exception& exception)
+	{
+		std::cerr << exception.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,224 @@
+#include "ObjGenerator.h"
+#include "camel/Core.h"
+
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace Camel
+{
+	namespace
+	{
+		constexpr float PI = 3.14159265358979f;
+
+		// Buffers text and flushes it to the stream in large blocks, the ofstream operators are far too slow for big files
+		class ObjWriter final
+		{
+		public:
+			ObjWriter(const std::string& filePath)
+				: m_File(filePath, std::ios::binary | std::ios::trunc), m_Size(0)
+			{
+				if (!m_File)
+				{
+					CAMEL_LOG_ERROR("Failed to open obj for writing at path: {}", filePath);
+					throw std::runtime_error("Failed to open obj for writing at path: " + filePath);
+				}
+				m_Buffer.reserve(BUFFER_SIZE + 256);
+			}
+
+			~ObjWriter() noexcept { Flush(); }
+
+			inline ObjWriter& Text(const char* text) noexcept
+			{
+				while (*text)
+					m_Buffer.push_back(*text++);
+				return *this;
+			}
+
+			template<typename T>
+			inline ObjWriter& Number(const T value) noexcept
+			{
+				char text[32];
+				const std::to_chars_result result = std::to_chars(text, text + sizeof(text), value);
+				m_Buffer.insert(m_Buffer.end(), text, result.ptr);
+				return *this;
+			}
+
+			inline ObjWriter& Vector(const char* keyword, const float x, const float y) noexcept
+			{
+				return Text(keyword).Text(" ").Number(x).Text(" ").Number(y).EndLine();
+			}
+
+			inline ObjWriter& Vector(const char* keyword, const float x, const float y, const float z) noexcept
+			{
+				return Text(keyword).Text(" ").Number(x).Text(" ").Number(y).Text(" ").Number(z).EndLine();
+			}
+
+			inline ObjWriter& EndLine() noexcept
+			{
+				m_Buffer.push_back('\n');
+				if (m_Buffer.size() >= BUFFER_SIZE)
+					Flush();
+				return *this;
+			}
+
+			inline size_t GetSize() noexcept
+			{
+				Flush();
+				return m_Size;
+			}
+
+		private:
+			inline void Flush() noexcept
+			{
+				m_File.write(m_Buffer.data(), m_Buffer.size());
+				m_Size += m_Buffer.size();
+				m_Buffer.clear();
+			}
+
+		private:
+			static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+			std::ofstream m_File;
+			std::vector<char> m_Buffer;
+			size_t m_Size;
+		};
+
+		void WriteGrid(ObjWriter& writer, const size_t triangleCount, const bool withAttributes)
+		{
+			const size_t side = std::max<size_t>(1, (size_t)std::sqrt(triangleCount / 2.0));
+
+			for (size_t y = 0; y <= side; y++)
+				for (size_t x = 0; x <= side; x++)
+					writer.Vector("v", (float)x, 0.0f, (float)y);
+
+			if (withAttributes)
+			{
+				for (size_t y = 0; y <= side; y++)
+					for (size_t x = 0; x <= side; x++)
+						writer.Vector("vt", (float)x / side, (float)y / side);
+
+				writer.Vector("vn", 0.0f, 1.0f, 0.0f);
+			}
+
+			for (size_t y = 0; y < side; y++)
+			{
+				for (size_t x = 0; x < side; x++)
+				{
+					const size_t corners[4] = { y * (side + 1) + x + 1, y * (side + 1) + x + 2, (y + 1) * (side + 1) + x + 2, (y + 1) * (side + 1) + x + 1 };
+
+					writer.Text("f");
+					for (const size_t corner : corners)
+					{
+						writer.Text(" ").Number(corner);
+						if (withAttributes)
+							writer.Text("/").Number(corner).Text("/1");
+					}
+					writer.EndLine();
+				}
+			}
+		}
+
+		void WriteSphere(ObjWriter& writer, const size_t triangleCount)
+		{
+			const size_t rings = std::max<size_t>(2, (size_t)std::sqrt(triangleCount / 4.0));
+			const size_t segments = rings * 2;
+
+			// The last column duplicates the first with u = 1, giving the texcoord seam real meshes have
+			for (size_t ring = 0; ring <= rings; ring++)
+			{
+				for (size_t segment = 0; segment <= segments; segment++)
+				{
+					const float theta = PI * ring / rings;
+					const float phi = 2.0f * PI * (segment % segments) / segments;
+					const float x = std::sin(theta) * std::cos(phi), y = std::cos(theta), z = std::sin(theta) * std::sin(phi);
+					writer.Vector("v", x, y, z);
+					writer.Vector("vt", (float)segment / segments, (float)ring / rings);
+					writer.Vector("vn", x, y, z);
+				}
+			}
+
+			auto corner = [&writer, segments](const size_t ring, const size_t segment) -> ObjWriter&
+			{
+				const size_t index = ring * (segments + 1) + segment + 1;
+				return writer.Text(" ").Number(index).Text("/").Number(index).Text("/").Number(index);
+			};
+
+			for (size_t ring = 0; ring < rings; ring++)
+			{
+				for (size_t segment = 0; segment < segments; segment++)
+				{
+					writer.Text("f");
+					corner(ring, segment);
+					corner(ring + 1, segment + 1);
+					corner(ring, segment + 1);
+					writer.EndLine();
+
+					writer.Text("f");
+					corner(ring, segment);
+					corner(ring + 1, segment);
+					corner(ring + 1, segment + 1);
+					writer.EndLine();
+				}
+			}
+		}
+
+		void WriteSparseNgons(ObjWriter& writer, const size_t triangleCount)
+		{
+			// Fixed seed so every run and every build sees the same file
+			std::mt19937 random(1234);
+			std::uniform_int_distribution<int> cornerCount(5, 12);
+			std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+
+			size_t written = 0;
+			while (written < triangleCount)
+			{
+				const int corners = cornerCount(random);
+				const float cx = position(random), cy = position(random), cz = position(random);
+
+				for (int i = 0; i < corners; i++)
+				{
+					const float angle = 2.0f * PI * i / corners;
+					writer.Vector("v", cx + std::cos(angle), cy + std::sin(angle), cz);
+				}
+				writer.Vector("vn", 0.0f, 0.0f, 1.0f);
+
+				writer.Text("f");
+				for (int i = 0; i < corners; i++)
+					writer.Text(" ").Number(i - corners).Text("//-1");
+				writer.EndLine();
+
+				written += corners - 2;
+			}
+		}
+	}
+
+	const char* ObjGenerator::GetShapeName(const ObjShape shape) noexcept
+	{
+		switch (shape)
+		{
+		case ObjShape::GRID: return "grid";
+		case ObjShape::SPHERE: return "sphere";
+		case ObjShape::SPARSE_NGON: return "sparse_ngon";
+		case ObjShape::POSITIONS_ONLY: return "positions_only";
+		}
+		return "unknown";
+	}
+
+	size_t ObjGenerator::Generate(const std::string& filePath, const ObjShape shape, const size_t triangleCount)
+	{
+		ObjWriter writer(filePath);
+
+		switch (shape)
+		{
+		case ObjShape::GRID: WriteGrid(writer, triangleCount, true); break;
+		case ObjShape::SPHERE: WriteSphere(writer, triangleCount); break;
+		case ObjShape::SPARSE_NGON: WriteSparseNgons(writer, triangleCount); break;
+		case ObjShape::POSITIONS_ONLY: WriteGrid(writer, triangleCount, false); break;
+		}
+
+		return writer.GetSize();
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+
+namespace Camel
+{
+	enum class ObjShape
+	{
+		GRID, // Quad grid with shared texcoords and normals, heavy deduplication
+		SPHERE, // UV sphere written as triangles with a texcoord seam
+		SPARSE_NGON, // Disconnected n-gons of 5 to 12 corners with negative indices, little deduplication
+		POSITIONS_ONLY, // Quad grid without texcoords or normals
+	};
+
+	// Writes synthetic wavefront obj files for benchmarking the importer
+	class ObjGenerator final
+	{
+	public:
+		static const char* GetShapeName(const ObjShape shape) noexcept;
+
+		// Writes a mesh of roughly triangleCount triangles after triangulation, returns the file size in bytes
+		static size_t Generate(const std::string& filePath, const ObjShape shape, const size_t triangleCount);
+
+	public:
+		ObjGenerator() = delete;
+	};
+}